@@ -0,0 +1,470 @@
+// -----------------------------------------------------------------------------
+// CAV_RangeSnapshotComponent.c
+// - Put on a prop at a range or course; a while after mission start it records
+//   every replicated entity within m_Radius (prefab, transform, health, target
+//   state)
+// - An instructor resets the course from the prop's action menu, in place and
+//   without a mission restart:
+//   - anything that wasn't there at snapshot time (dropped gear, thrown
+//     items, corpses, GM-spawned props) is deleted
+//   - recorded props are moved back and healed, targets are put back in their
+//     recorded state; destroyed or missing ones and changed vehicles are
+//     respawned from their prefab (full fuel, ammo and health)
+//   - recruits in the area keep their body and get a fresh Recruit kit swapped
+//     into their inventory on the spot
+//   - vehicles with someone inside are left alone
+// - The reset is spread over frames (m_OpsPerFrame) so a class change doesn't
+//   hitch the server
+// - Self-contained on purpose: the Bootcamp addon doesn't depend on 7Cav Systems
+// -----------------------------------------------------------------------------
+
+class CAV_RangeSnapshotRecord
+{
+	ResourceName m_Prefab;
+	vector m_Transform[4];
+	float m_Health = 1;
+	int m_TargetState = -1;     // ETargetState of a firing range target, -1 otherwise
+	IEntity m_Entity;           // current instance; replaced when respawned
+}
+
+class CAV_RangeSnapshotComponentClass : ScriptComponentClass {}
+
+[ComponentEditorProps(category: "Training", description: "Snapshots the entities around a range and restores them in place")]
+class CAV_RangeSnapshotComponent : ScriptComponent
+{
+	[Attribute(defvalue: "150", uiwidget: UIWidgets.EditBox, desc: "Radius of the range/course around this entity (m)", params: "5 1000 1")]
+	protected float m_Radius;
+
+	[Attribute(defvalue: "15", uiwidget: UIWidgets.EditBox, desc: "Seconds after mission start before the snapshot is taken", params: "0 300 1")]
+	protected float m_SnapshotDelayS;
+
+	[Attribute(defvalue: "0.25", uiwidget: UIWidgets.EditBox, desc: "Recorded entities further than this from their snapshot position are moved back (m)", params: "0 10 0.05")]
+	protected float m_PositionTolerance;
+
+	[Attribute(defvalue: "8", uiwidget: UIWidgets.EditBox, desc: "Entities deleted, restored or respawned per frame during a reset", params: "1 128 1")]
+	protected int m_OpsPerFrame;
+
+	[Attribute(defvalue: "{284E735C6C70DAD3}Prefabs/Characters/Factions/BLUFOR/US_Army/Recruit.et", uiwidget: UIWidgets.ResourcePickerThumbnail, desc: "Players on this prefab get a fresh loadout on reset", params: "et")]
+	protected ResourceName m_RecruitPrefab;
+
+	[Attribute(defvalue: "{E14AEDAFBDF24078}Prefabs/Characters/Factions/BLUFOR/US_Army/Instructor.et", uiwidget: UIWidgets.ResourcePickerThumbnail, desc: "Only players on this prefab may reset the range", params: "et")]
+	protected ResourceName m_InstructorPrefab;
+
+	// --- State ---------------------------------------------------------------
+	protected ref array<ref CAV_RangeSnapshotRecord> m_Records = {};
+	protected ref set<IEntity> m_Known = new set<IEntity>();
+	protected bool m_HasSnapshot;
+
+	// Pending reset work, drained front to back
+	protected ref array<IEntity> m_ToDelete = {};
+	protected ref array<CAV_RangeSnapshotRecord> m_ToRestore = {};
+	protected ref array<int> m_ToReequip = {};
+	protected bool m_Resetting;
+
+	protected ref array<IEntity> m_QueryResult = {};
+
+	protected static const float KIT_DONOR_DEPTH = 200;
+	protected static const int KIT_DONOR_LIFETIME_MS = 1000;
+
+	// --- Lifecycle -----------------------------------------------------------
+	override protected void OnPostInit(IEntity owner)
+	{
+		super.OnPostInit(owner);
+
+		if (!Replication.IsServer())
+			return;
+
+		GetGame().GetCallqueue().CallLater(TakeSnapshot, m_SnapshotDelayS * 1000, false);
+	}
+
+	override protected void OnDelete(IEntity owner)
+	{
+		GetGame().GetCallqueue().Remove(TakeSnapshot);
+		super.OnDelete(owner);
+	}
+
+	// --- Access --------------------------------------------------------------
+	// Snapshot and reset state only exist on the server; clients just check the user
+	bool CanReset(IEntity user)
+	{
+		if (!user || m_Resetting)
+			return false;
+
+		if (Replication.IsServer() && !m_HasSnapshot)
+			return false;
+
+		return GetPrefabName(user) == m_InstructorPrefab;
+	}
+
+	bool IsResetting()
+	{
+		return m_Resetting;
+	}
+
+	// --- Snapshot ------------------------------------------------------------
+	void TakeSnapshot()
+	{
+		if (!Replication.IsServer() || m_Resetting)
+			return;
+
+		m_Records.Clear();
+		m_Known.Clear();
+
+		Query();
+		foreach (IEntity ent : m_QueryResult)
+		{
+			// Players and their bodies are not part of the course
+			if (ChimeraCharacter.Cast(ent))
+				continue;
+
+			CAV_RangeSnapshotRecord record = new CAV_RangeSnapshotRecord();
+			record.m_Prefab = GetPrefabName(ent);
+			ent.GetWorldTransform(record.m_Transform);
+			record.m_Entity = ent;
+
+			SCR_DamageManagerComponent damage = SCR_DamageManagerComponent.GetDamageManager(ent);
+			if (damage)
+				record.m_Health = damage.GetHealthScaled();
+
+			SCR_FiringRangeTarget target = SCR_FiringRangeTarget.Cast(ent);
+			if (target)
+				record.m_TargetState = target.GetState();
+
+			m_Records.Insert(record);
+			m_Known.Insert(ent);
+		}
+
+		m_HasSnapshot = true;
+		PrintFormat("[CAV_RangeSnapshot] %1: %2 entities recorded within %3 m", GetOwner().GetOrigin(), m_Records.Count(), m_Radius);
+	}
+
+	// --- Reset ---------------------------------------------------------------
+	void Reset()
+	{
+		if (!Replication.IsServer() || !m_HasSnapshot || m_Resetting)
+			return;
+
+		m_ToDelete.Clear();
+		m_ToRestore.Clear();
+		m_ToReequip.Clear();
+
+		Query();
+		foreach (IEntity ent : m_QueryResult)
+		{
+			if (m_Known.Contains(ent))
+				continue;
+
+			ChimeraCharacter character = ChimeraCharacter.Cast(ent);
+			if (character)
+			{
+				int playerId = GetGame().GetPlayerManager().GetPlayerIdFromControlledEntity(character);
+				if (playerId > 0)
+				{
+					if (GetPrefabName(character) == m_RecruitPrefab && !IsDead(character))
+						m_ToReequip.Insert(playerId);
+					continue;
+				}
+
+				// Only corpses go; live AI belongs to whoever placed it
+				if (!IsDead(character))
+					continue;
+			}
+
+			// A vehicle recruits drove in is deleted only once they're out of it
+			if (IsOccupied(ent))
+				continue;
+
+			m_ToDelete.Insert(ent);
+		}
+
+		foreach (CAV_RangeSnapshotRecord record : m_Records)
+		{
+			m_ToRestore.Insert(record);
+		}
+
+		PrintFormat("[CAV_RangeSnapshot] %1: reset started (%2 to delete, %3 to check, %4 recruits)", GetOwner().GetOrigin(), m_ToDelete.Count(), m_ToRestore.Count(), m_ToReequip.Count());
+
+		m_Resetting = true;
+		SetEventMask(GetOwner(), EntityEvent.FRAME);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	override protected void EOnFrame(IEntity owner, float timeSlice)
+	{
+		int ops = 0;
+
+		// Clear out what doesn't belong first, so respawns don't collide with it
+		while (ops < m_OpsPerFrame && !m_ToDelete.IsEmpty())
+		{
+			IEntity ent = m_ToDelete[0];
+			m_ToDelete.RemoveOrdered(0);
+			if (!ent) continue;
+
+			SCR_EntityHelper.DeleteEntityAndChildren(ent);
+			ops++;
+		}
+
+		while (ops < m_OpsPerFrame && m_ToDelete.IsEmpty() && !m_ToRestore.IsEmpty())
+		{
+			CAV_RangeSnapshotRecord record = m_ToRestore[0];
+			m_ToRestore.RemoveOrdered(0);
+
+			if (Restore(record))
+				ops++;
+		}
+
+		while (ops < m_OpsPerFrame && m_ToRestore.IsEmpty() && !m_ToReequip.IsEmpty())
+		{
+			int playerId = m_ToReequip[0];
+			m_ToReequip.RemoveOrdered(0);
+
+			if (Reequip(playerId))
+				ops++;
+		}
+
+		if (m_ToDelete.IsEmpty() && m_ToRestore.IsEmpty() && m_ToReequip.IsEmpty())
+		{
+			m_Resetting = false;
+			ClearEventMask(owner, EntityEvent.FRAME);
+			PrintFormat("[CAV_RangeSnapshot] %1: reset done", owner.GetOrigin());
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------
+	// False if the entity was already as recorded
+	protected bool Restore(CAV_RangeSnapshotRecord record)
+	{
+		IEntity ent = record.m_Entity;
+		if (!ent || IsDead(ent))
+			return Respawn(record);
+
+		bool moved = vector.Distance(ent.GetOrigin(), record.m_Transform[3]) > m_PositionTolerance;
+		SCR_DamageManagerComponent damage = SCR_DamageManagerComponent.GetDamageManager(ent);
+		bool damaged = damage && damage.GetHealthScaled() < record.m_Health;
+
+		// A used vehicle has also burnt fuel and ammo; a fresh one is the simplest full restore
+		if (Vehicle.Cast(ent))
+		{
+			if (!moved && !damaged && !IsFuelUsed(ent))
+				return false;
+
+			if (IsOccupied(ent))
+			{
+				PrintFormat("[CAV_RangeSnapshot] %1 is occupied, left as is", record.m_Prefab, level: LogLevel.WARNING);
+				return false;
+			}
+
+			SCR_EntityHelper.DeleteEntityAndChildren(ent);
+			return Respawn(record);
+		}
+
+		bool changed = moved || damaged;
+		if (moved)
+		{
+			BaseGameEntity gameEntity = BaseGameEntity.Cast(ent);
+			if (gameEntity)
+				gameEntity.Teleport(record.m_Transform);
+			else
+				ent.SetWorldTransform(record.m_Transform);
+
+			Physics physics = ent.GetPhysics();
+			if (physics && physics.IsDynamic())
+			{
+				physics.SetVelocity(vector.Zero);
+				physics.SetAngularVelocity(vector.Zero);
+			}
+		}
+
+		if (damaged)
+			damage.FullHeal();
+
+		SCR_FiringRangeTarget target = SCR_FiringRangeTarget.Cast(ent);
+		if (target && target.GetState() != record.m_TargetState)
+		{
+			target.SetState(record.m_TargetState);
+			changed = true;
+		}
+
+		return changed;
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected bool Respawn(CAV_RangeSnapshotRecord record)
+	{
+		IEntity ent = SpawnAt(record.m_Prefab, record.m_Transform);
+		if (!ent)
+		{
+			PrintFormat("[CAV_RangeSnapshot] Could not respawn %1", record.m_Prefab, level: LogLevel.WARNING);
+			return false;
+		}
+
+		m_Known.RemoveItem(record.m_Entity);
+		m_Known.Insert(ent);
+		record.m_Entity = ent;
+
+		SCR_FiringRangeTarget target = SCR_FiringRangeTarget.Cast(ent);
+		if (target && record.m_TargetState != -1)
+			target.SetState(record.m_TargetState);
+
+		return true;
+	}
+
+	//------------------------------------------------------------------------------------------------
+	// Re-kit the recruit in place: the kit of a fresh Recruit body, spawned out of sight
+	// under the range, is swapped into the same slots and the used kit goes with the donor
+	protected bool Reequip(int playerId)
+	{
+		PlayerController controller = GetGame().GetPlayerManager().GetPlayerController(playerId);
+		if (!controller) return false;
+
+		IEntity body = controller.GetControlledEntity();
+		if (!body || IsDead(body) || GetPrefabName(body) != m_RecruitPrefab)
+			return false;
+
+		SCR_InventoryStorageManagerComponent inventory = SCR_InventoryStorageManagerComponent.Cast(body.FindComponent(SCR_InventoryStorageManagerComponent));
+		if (!inventory) return false;
+
+		vector transform[4];
+		GetOwner().GetWorldTransform(transform);
+		transform[3] = transform[3] - Vector(0, KIT_DONOR_DEPTH, 0);
+
+		IEntity donor = SpawnAt(m_RecruitPrefab, transform);
+		if (!donor) return false;
+
+		SwapKit(inventory, EquipedLoadoutStorageComponent.Cast(body.FindComponent(EquipedLoadoutStorageComponent)), EquipedLoadoutStorageComponent.Cast(donor.FindComponent(EquipedLoadoutStorageComponent)));
+		SwapKit(inventory, EquipedWeaponStorageComponent.Cast(body.FindComponent(EquipedWeaponStorageComponent)), EquipedWeaponStorageComponent.Cast(donor.FindComponent(EquipedWeaponStorageComponent)));
+
+		// Moves finish before the donor and anything it still holds go
+		GetGame().GetCallqueue().CallLater(SCR_EntityHelper.DeleteEntityAndChildren, KIT_DONOR_LIFETIME_MS, false, donor);
+		return true;
+	}
+
+	//------------------------------------------------------------------------------------------------
+	// Same prefab on both sides, so slot i holds the same kind of item. A filled slot
+	// is swapped, so the used item ends up on the donor and goes with it; a slot whose
+	// swap fails keeps what the recruit had
+	protected static void SwapKit(SCR_InventoryStorageManagerComponent inventory, BaseInventoryStorageComponent storage, BaseInventoryStorageComponent fresh)
+	{
+		if (!storage || !fresh) return;
+
+		int count = Math.Min(storage.GetSlotsCount(), fresh.GetSlotsCount());
+		for (int i = 0; i < count; i++)
+		{
+			IEntity item = fresh.Get(i);
+			if (!item) continue;
+
+			if (storage.Get(i))
+				inventory.TryReplaceItem(item, storage, i);
+			else
+				inventory.TryMoveItemToStorage(item, storage, i);
+		}
+	}
+
+	// --- Helpers -------------------------------------------------------------
+	protected void Query()
+	{
+		m_QueryResult.Clear();
+		GetOwner().GetWorld().QueryEntitiesBySphere(GetOwner().GetOrigin(), m_Radius, AddEntity, null, EQueryEntitiesFlags.ALL);
+	}
+
+	// Replicated prefab roots only; local effects, decals and the like are left alone
+	protected bool AddEntity(IEntity ent)
+	{
+		if (ent == GetOwner() || ent.GetParent() || !ent.GetPrefabData())
+			return true;
+
+		if (!ent.FindComponent(RplComponent))
+			return true;
+
+		m_QueryResult.Insert(ent);
+		return true;
+	}
+
+	protected IEntity SpawnAt(ResourceName prefab, vector transform[4])
+	{
+		Resource res = Resource.Load(prefab);
+		if (!res || !res.IsValid()) return null;
+
+		EntitySpawnParams params = new EntitySpawnParams();
+		params.TransformMode = ETransformMode.WORLD;
+		for (int i = 0; i < 4; i++)
+			params.Transform[i] = transform[i];
+
+		return GetGame().SpawnEntityPrefab(res, GetOwner().GetWorld(), params);
+	}
+
+	protected static bool IsDead(IEntity ent)
+	{
+		SCR_DamageManagerComponent damage = SCR_DamageManagerComponent.GetDamageManager(ent);
+		return damage && damage.GetState() == EDamageState.DESTROYED;
+	}
+
+	protected static bool IsOccupied(IEntity vehicle)
+	{
+		SCR_BaseCompartmentManagerComponent compartments = SCR_BaseCompartmentManagerComponent.Cast(vehicle.FindComponent(SCR_BaseCompartmentManagerComponent));
+		if (!compartments) return false;
+
+		array<IEntity> occupants = {};
+		compartments.GetOccupants(occupants);
+		return !occupants.IsEmpty();
+	}
+
+	protected static bool IsFuelUsed(IEntity vehicle)
+	{
+		FuelManagerComponent fuel = FuelManagerComponent.Cast(vehicle.FindComponent(FuelManagerComponent));
+		if (!fuel) return false;
+
+		return fuel.GetTotalFuel() < fuel.GetTotalMaxFuel();
+	}
+
+	protected static ResourceName GetPrefabName(IEntity ent)
+	{
+		EntityPrefabData prefabData = ent.GetPrefabData();
+		if (!prefabData) return ResourceName.Empty;
+		return prefabData.GetPrefabName();
+	}
+}
+
+// ---- Action on the range prop; instructors only
+class CAV_RangeResetUserAction : ScriptedUserAction
+{
+	protected CAV_RangeSnapshotComponent m_Snapshot;
+
+	//------------------------------------------------------------------------------------------------
+	override void Init(IEntity pOwnerEntity, GenericComponent pManagerComponent)
+	{
+		m_Snapshot = CAV_RangeSnapshotComponent.Cast(pOwnerEntity.FindComponent(CAV_RangeSnapshotComponent));
+	}
+
+	//------------------------------------------------------------------------------------------------
+	override bool CanBeShownScript(IEntity user)
+	{
+		return m_Snapshot != null;
+	}
+
+	//------------------------------------------------------------------------------------------------
+	override bool CanBePerformedScript(IEntity user)
+	{
+		if (m_Snapshot && m_Snapshot.IsResetting())
+		{
+			SetCannotPerformReason("Resetting...");
+			return false;
+		}
+
+		if (!m_Snapshot || !m_Snapshot.CanReset(user))
+		{
+			SetCannotPerformReason("Instructors only");
+			return false;
+		}
+
+		return true;
+	}
+
+	//------------------------------------------------------------------------------------------------
+	override void PerformAction(IEntity pOwnerEntity, IEntity pUserEntity)
+	{
+		// Runs on the server as well as the performing client; only the server resets
+		if (m_Snapshot && Replication.IsServer() && m_Snapshot.CanReset(pUserEntity))
+			m_Snapshot.Reset();
+	}
+}
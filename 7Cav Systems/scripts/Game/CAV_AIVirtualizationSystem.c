@@ -0,0 +1,533 @@
+// -----------------------------------------------------------------------------
+// CAV_AIVirtualizationSystem.c
+// - Adopted AI groups far from every player collapse into a CAV_VirtualGroupRecord
+//   (prefab, leader position/yaw, surviving members' health, remaining waypoints)
+//   and their entities/agents are deleted
+// - A player coming within m_RehydrateRadius respawns the group from the record
+// - Virtual records sit in a CAV_SpatialGrid; only cells around players are
+//   looked at, so thousands of parked groups cost nothing per tick
+// - Groups in vehicles are never virtualized (the vehicle would be left behind)
+// - Rehydration waits while m_MaxLiveAI AI are alive, like patrol spawns do
+// - Ambient patrols are adopted as their spawn point spawns them, with or
+//   without CAV_PatrolSchedulerSystem. The group is detached from its point
+//   while virtual (the point won't roll a fresh one meanwhile) and handed back
+//   on rehydrate, so the point's own bookkeeping stays right
+// -----------------------------------------------------------------------------
+
+class CAV_VirtualGroupRecord
+{
+	ResourceName m_Prefab;
+	vector m_Position;
+	float m_Yaw;
+	int m_AliveCount;
+	ref array<float> m_MemberHealth = {};
+	ref array<AIWaypoint> m_Waypoints = {};
+
+	SCR_AIGroup m_Group;       // live group, null while virtual
+	bool m_Virtual;
+	float m_FarSinceS = -1;    // -1 while observed
+	float m_GraceUntilS;       // members still spawning in until then
+	int m_HealthApplied;       // rehydrate: health entries already restored
+	SCR_AmbientPatrolSpawnPointComponent m_SpawnPoint;   // ambient patrol point that spawned it
+	int m_PatrolPointId = -1;  // CAV_PatrolSchedulerSystem id of that point
+	int m_SeenStamp;
+}
+
+class CAV_AIVirtualizationSystem : GameSystem
+{
+	[Attribute(defvalue: "1", uiwidget: UIWidgets.CheckBox, desc: "Virtualize distant AI groups")]
+	protected bool m_Active;
+
+	[Attribute(defvalue: "500", uiwidget: UIWidgets.EditBox, desc: "Grid cell size (m)", params: "50 5000 10")]
+	protected float m_CellSize;
+
+	[Attribute(defvalue: "1500", uiwidget: UIWidgets.EditBox, desc: "Virtualize a group when every player is beyond this range (m)", params: "100 8000 10")]
+	protected float m_VirtualizeRadius;
+
+	[Attribute(defvalue: "1200", uiwidget: UIWidgets.EditBox, desc: "Rehydrate a virtual group when a player is within this range (m); keep < virtualize radius", params: "100 8000 10")]
+	protected float m_RehydrateRadius;
+
+	[Attribute(defvalue: "20", uiwidget: UIWidgets.EditBox, desc: "Seconds a group must stay unobserved before it is virtualized", params: "0 600 1")]
+	protected float m_VirtualizeDelayS;
+
+	[Attribute(defvalue: "10", uiwidget: UIWidgets.EditBox, desc: "Seconds after a (re)spawn before an empty group counts as eliminated", params: "1 120 1")]
+	protected float m_SpawnGraceS;
+
+	[Attribute(defvalue: "2", uiwidget: UIWidgets.EditBox, desc: "Seconds between proximity evaluations", params: "0.25 30 0.25")]
+	protected float m_EvaluateIntervalS;
+
+	[Attribute(defvalue: "2", uiwidget: UIWidgets.EditBox, desc: "Max groups virtualized per frame", params: "1 32 1")]
+	protected int m_MaxVirtualizePerFrame;
+
+	[Attribute(defvalue: "1", uiwidget: UIWidgets.EditBox, desc: "Max groups rehydrated per frame", params: "1 16 1")]
+	protected int m_MaxRehydratePerFrame;
+
+	[Attribute(defvalue: "160", uiwidget: UIWidgets.EditBox, desc: "No rehydration while this many AI are alive", params: "0 1000 1")]
+	protected int m_MaxLiveAI;
+
+	// --- State ---------------------------------------------------------------
+	// Record ids index m_Records and are never reused; a dropped record is null
+	protected ref array<ref CAV_VirtualGroupRecord> m_Records = {};
+	protected ref map<SCR_AIGroup, int> m_IdByGroup = new map<SCR_AIGroup, int>();
+	protected ref array<int> m_LiveIds = {};
+	protected ref CAV_SpatialGrid m_VirtualGrid;
+	protected int m_VirtualCount;
+
+	protected ref array<int> m_VirtualizeQueue = {};
+	protected ref array<int> m_RehydrateQueue = {};
+
+	protected ref array<vector> m_PlayerPositions = {};
+	protected ref array<int> m_Candidates = {};
+	protected ref array<AIAgent> m_Agents = {};
+	protected int m_EvalStamp;
+	protected float m_NextEvalS;
+
+	//------------------------------------------------------------------------------------------------
+	override static void InitInfo(WorldSystemInfo outInfo)
+	{
+		outInfo
+			.SetAbstract(false)
+			.SetLocation(ESystemLocation.Server)
+			.AddPoint(ESystemPoint.Frame);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	static CAV_AIVirtualizationSystem GetInstance()
+	{
+		World world = GetGame().GetWorld();
+		if (!world) return null;
+		return CAV_AIVirtualizationSystem.Cast(world.FindSystem(CAV_AIVirtualizationSystem));
+	}
+
+	//------------------------------------------------------------------------------------------------
+	override protected void OnInit()
+	{
+		m_VirtualGrid = new CAV_SpatialGrid(m_CellSize);
+		if (m_RehydrateRadius > m_VirtualizeRadius)
+			m_RehydrateRadius = m_VirtualizeRadius;
+
+		Enable(false);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	bool IsActive()
+	{
+		return m_Active;
+	}
+
+	// --- Adoption ------------------------------------------------------------
+	// Take over a freshly spawned group. patrolPointId is reported back to the
+	// patrol scheduler when the group is eliminated (-1 = not a scheduled patrol);
+	// adopting an already adopted group only fills that in.
+	void Adopt(notnull SCR_AIGroup group, SCR_AmbientPatrolSpawnPointComponent spawnPoint = null, int patrolPointId = -1)
+	{
+		int existing;
+		if (m_IdByGroup.Find(group, existing))
+		{
+			if (patrolPointId >= 0)
+				m_Records[existing].m_PatrolPointId = patrolPointId;
+			return;
+		}
+
+		CAV_VirtualGroupRecord rec = new CAV_VirtualGroupRecord();
+		rec.m_Prefab = GetPrefabName(group);
+		rec.m_Group = group;
+		rec.m_SpawnPoint = spawnPoint;
+		rec.m_PatrolPointId = patrolPointId;
+		rec.m_GraceUntilS = GetNowS() + m_SpawnGraceS;
+
+		int id = m_Records.Insert(rec);
+		m_IdByGroup.Insert(group, id);
+		m_LiveIds.Insert(id);
+
+		Enable(true);
+	}
+
+	int GetVirtualCount()
+	{
+		return m_VirtualCount;
+	}
+
+	// --- Frame update --------------------------------------------------------
+	override protected void OnUpdate(ESystemPoint point)
+	{
+		CAV_PerfScope perfScope = CAV_Perf.Scope("virt.frame_ms");
+
+		float nowS = GetNowS();
+		if (nowS >= m_NextEvalS)
+		{
+			m_NextEvalS = nowS + m_EvaluateIntervalS;
+			Evaluate(nowS);
+		}
+
+		DrainVirtualize(nowS);
+		DrainRehydrate(nowS);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected void Evaluate(float nowS)
+	{
+		CAV_SpatialGrid.GatherPlayerPositions(m_PlayerPositions);
+		m_EvalStamp++;
+
+		float virtualizeSq = m_VirtualizeRadius * m_VirtualizeRadius;
+		float rehydrateSq = m_RehydrateRadius * m_RehydrateRadius;
+
+		// Live groups: notice eliminations, apply hysteresis
+		for (int i = m_LiveIds.Count() - 1; i >= 0; i--)
+		{
+			int id = m_LiveIds[i];
+			CAV_VirtualGroupRecord rec = m_Records[id];
+			SCR_AIGroup group = rec.m_Group;
+
+			if (!group || (group.GetAgentsCount() == 0 && nowS >= rec.m_GraceUntilS))
+			{
+				m_LiveIds.Remove(i);
+				Drop(id, nowS);
+				CAV_Perf.Count("virt.eliminated");
+				continue;
+			}
+
+			if (CAV_SpatialGrid.MinDistanceSq2D(GetGroupPosition(group), m_PlayerPositions) <= virtualizeSq)
+			{
+				rec.m_FarSinceS = -1;
+				continue;
+			}
+
+			if (rec.m_FarSinceS < 0)
+				rec.m_FarSinceS = nowS;
+			else if (nowS - rec.m_FarSinceS >= m_VirtualizeDelayS && m_VirtualizeQueue.Find(id) == -1)
+				m_VirtualizeQueue.Insert(id);
+		}
+
+		// Virtual groups: only cells around players
+		foreach (vector playerPos : m_PlayerPositions)
+		{
+			m_Candidates.Clear();
+			m_VirtualGrid.QueryRadius(playerPos, m_RehydrateRadius, m_Candidates);
+
+			foreach (int id : m_Candidates)
+			{
+				CAV_VirtualGroupRecord rec = m_Records[id];
+				if (!rec || !rec.m_Virtual || rec.m_SeenStamp == m_EvalStamp) continue;
+				rec.m_SeenStamp = m_EvalStamp;
+
+				if (vector.DistanceSqXZ(rec.m_Position, playerPos) > rehydrateSq) continue;
+				if (m_RehydrateQueue.Find(id) == -1)
+					m_RehydrateQueue.Insert(id);
+			}
+		}
+
+		CAV_Perf.Sample("virt.live", m_LiveIds.Count());
+		CAV_Perf.Sample("virt.virtual", GetVirtualCount());
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected void DrainVirtualize(float nowS)
+	{
+		int done = 0;
+		while (!m_VirtualizeQueue.IsEmpty() && done < m_MaxVirtualizePerFrame)
+		{
+			int id = m_VirtualizeQueue[0];
+			m_VirtualizeQueue.RemoveOrdered(0);
+
+			CAV_VirtualGroupRecord rec = m_Records[id];
+			if (!rec || rec.m_Virtual || !rec.m_Group) continue;
+
+			// A player came back while it was queued
+			if (rec.m_FarSinceS < 0) continue;
+
+			if (Virtualize(id, rec))
+				done++;
+		}
+
+		CAV_Perf.Count("virt.virtualized", done);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected void DrainRehydrate(float nowS)
+	{
+		AIWorld aiWorld = GetGame().GetAIWorld();
+		int done = 0;
+		while (!m_RehydrateQueue.IsEmpty() && done < m_MaxRehydratePerFrame)
+		{
+			// Over the cap: leave the queue intact and try again next frame
+			if (aiWorld && m_MaxLiveAI > 0 && aiWorld.GetCurrentAmountOfLimitedAIs() >= m_MaxLiveAI)
+			{
+				CAV_Perf.Count("virt.capped_frames");
+				break;
+			}
+
+			int id = m_RehydrateQueue[0];
+			m_RehydrateQueue.RemoveOrdered(0);
+
+			CAV_VirtualGroupRecord rec = m_Records[id];
+			if (!rec || !rec.m_Virtual) continue;
+
+			if (Rehydrate(id, rec, nowS))
+				done++;
+		}
+
+		CAV_Perf.Count("virt.rehydrated", done);
+	}
+
+	// --- Collapse / restore --------------------------------------------------
+	protected bool Virtualize(int id, CAV_VirtualGroupRecord rec)
+	{
+		SCR_AIGroup group = rec.m_Group;
+
+		m_Agents.Clear();
+		group.GetAgents(m_Agents);
+
+		// Leave groups alone while anyone is mounted; re-checked next evaluation
+		foreach (AIAgent agent : m_Agents)
+		{
+			ChimeraCharacter character = ChimeraCharacter.Cast(agent.GetControlledEntity());
+			if (character && character.IsInVehicle())
+			{
+				rec.m_FarSinceS = -1;
+				return false;
+			}
+		}
+
+		rec.m_MemberHealth.Clear();
+		foreach (AIAgent agent : m_Agents)
+		{
+			IEntity member = agent.GetControlledEntity();
+			if (!member) continue;
+
+			float health = 1;
+			SCR_DamageManagerComponent dmg = SCR_DamageManagerComponent.Cast(member.FindComponent(SCR_DamageManagerComponent));
+			if (dmg)
+			{
+				if (dmg.GetState() == EDamageState.DESTROYED) continue;
+				health = dmg.GetHealthScaled();
+			}
+			rec.m_MemberHealth.Insert(health);
+		}
+		rec.m_AliveCount = rec.m_MemberHealth.Count();
+
+		// Nobody left to keep; elimination is picked up by the next evaluation
+		if (rec.m_AliveCount == 0)
+			return false;
+
+		IEntity leader = group.GetLeaderEntity();
+		if (leader)
+		{
+			rec.m_Position = leader.GetOrigin();
+			rec.m_Yaw = leader.GetYawPitchRoll()[0];
+		}
+		else
+		{
+			rec.m_Position = group.GetOrigin();
+			rec.m_Yaw = group.GetYawPitchRoll()[0];
+		}
+
+		// Remaining route, starting at the waypoint the group is heading for
+		rec.m_Waypoints.Clear();
+		array<AIWaypoint> waypoints = {};
+		group.GetWaypoints(waypoints);
+		int start = Math.Max(waypoints.Find(group.GetCurrentWaypoint()), 0);
+		for (int w = start; w < waypoints.Count(); w++)
+			rec.m_Waypoints.Insert(waypoints[w]);
+
+		// The point must not read the deletion below as its patrol being killed
+		SCR_AmbientPatrolSpawnPointComponent spawnPoint = GetPatrolPoint(rec);
+		if (spawnPoint)
+			spawnPoint.CAV_DetachGroup();
+
+		foreach (AIAgent agent : m_Agents)
+		{
+			IEntity member = agent.GetControlledEntity();
+			if (member)
+				SCR_EntityHelper.DeleteEntityAndChildren(member);
+		}
+
+		m_IdByGroup.Remove(group);
+		m_LiveIds.RemoveItem(id);
+		SCR_EntityHelper.DeleteEntityAndChildren(group);
+		rec.m_Group = null;
+
+		rec.m_Virtual = true;
+		m_VirtualCount++;
+		m_VirtualGrid.Insert(id, rec.m_Position);
+		return true;
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected bool Rehydrate(int id, CAV_VirtualGroupRecord rec, float nowS)
+	{
+		Resource res = Resource.Load(rec.m_Prefab);
+		if (!res || !res.IsValid())
+		{
+			PrintFormat("[CAV_AIVirtualization] Cannot load %1, dropping record", rec.m_Prefab, level: LogLevel.WARNING);
+			m_VirtualGrid.Remove(id, rec.m_Position);
+			m_VirtualCount--;
+			Drop(id, nowS);
+			return false;
+		}
+
+		EntitySpawnParams params = new EntitySpawnParams();
+		params.TransformMode = ETransformMode.WORLD;
+		Math3D.AnglesToMatrix(Vector(rec.m_Yaw, 0, 0), params.Transform);
+		params.Transform[3] = rec.m_Position;
+
+		SCR_AIGroup group = SCR_AIGroup.Cast(GetGame().SpawnEntityPrefab(res, GetWorld(), params));
+		if (!group) return false;
+
+		group.SetMaxUnitsToSpawn(rec.m_AliveCount);
+		foreach (AIWaypoint waypoint : rec.m_Waypoints)
+		{
+			if (waypoint)
+				group.AddWaypoint(waypoint);
+		}
+
+		rec.m_Virtual = false;
+		m_VirtualCount--;
+		rec.m_Group = group;
+		rec.m_FarSinceS = -1;
+		rec.m_GraceUntilS = nowS + m_SpawnGraceS;
+		rec.m_HealthApplied = 0;
+
+		m_VirtualGrid.Remove(id, rec.m_Position);
+		m_IdByGroup.Insert(group, id);
+		m_LiveIds.Insert(id);
+
+		group.GetOnAgentAdded().Insert(OnRehydratedAgentAdded);
+		CAV_FireMissionSystem.RegisterIfArtillery(group);
+
+		SCR_AmbientPatrolSpawnPointComponent spawnPoint = GetPatrolPoint(rec);
+		if (spawnPoint)
+			spawnPoint.CAV_RestoreGroup(group);
+
+		return true;
+	}
+
+	//------------------------------------------------------------------------------------------------
+	// Members spawn over several frames; hand out the recorded health in order
+	protected void OnRehydratedAgentAdded(AIAgent agent)
+	{
+		if (!agent) return;
+
+		SCR_AIGroup group = SCR_AIGroup.Cast(agent.GetParentGroup());
+		int id;
+		if (!group || !m_IdByGroup.Find(group, id)) return;
+
+		CAV_VirtualGroupRecord rec = m_Records[id];
+		if (rec.m_HealthApplied >= rec.m_MemberHealth.Count())
+		{
+			group.GetOnAgentAdded().Remove(OnRehydratedAgentAdded);
+			return;
+		}
+
+		float health = rec.m_MemberHealth[rec.m_HealthApplied];
+		rec.m_HealthApplied++;
+		if (health >= 1) return;
+
+		IEntity member = agent.GetControlledEntity();
+		if (!member) return;
+
+		SCR_DamageManagerComponent dmg = SCR_DamageManagerComponent.Cast(member.FindComponent(SCR_DamageManagerComponent));
+		if (dmg)
+			dmg.SetHealthScaled(health);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected void Drop(int id, float nowS)
+	{
+		CAV_VirtualGroupRecord rec = m_Records[id];
+		if (!rec) return;
+
+		if (rec.m_Group)
+			m_IdByGroup.Remove(rec.m_Group);
+
+		// A record lost while virtual must not keep its point blocked
+		if (rec.m_Virtual && rec.m_SpawnPoint)
+			rec.m_SpawnPoint.CAV_ReleaseGroup();
+
+		if (rec.m_PatrolPointId >= 0)
+		{
+			CAV_PatrolSchedulerSystem scheduler = CAV_PatrolSchedulerSystem.GetInstance();
+			if (scheduler)
+				scheduler.OnHandedOffEliminated(rec.m_PatrolPointId, nowS);
+		}
+
+		m_Records[id] = null;
+	}
+
+	// --- Helpers -------------------------------------------------------------
+	protected float GetNowS()
+	{
+		return GetWorld().GetWorldTime() * 0.001;
+	}
+
+	protected SCR_AmbientPatrolSpawnPointComponent GetPatrolPoint(CAV_VirtualGroupRecord rec)
+	{
+		return rec.m_SpawnPoint;
+	}
+
+	protected static vector GetGroupPosition(SCR_AIGroup group)
+	{
+		IEntity leader = group.GetLeaderEntity();
+		if (leader) return leader.GetOrigin();
+		return group.GetOrigin();
+	}
+
+	protected static ResourceName GetPrefabName(IEntity ent)
+	{
+		EntityPrefabData prefabData = ent.GetPrefabData();
+		if (!prefabData) return ResourceName.Empty;
+		return prefabData.GetPrefabName();
+	}
+}
+
+// ---- Hand spawned ambient patrols over; keep the point quiet while its group is virtual
+modded class SCR_AmbientPatrolSpawnPointComponent
+{
+	protected bool m_CAV_Virtualized;
+
+	override void SpawnPatrol()
+	{
+		// The record will bring the group back; don't roll a fresh one
+		if (m_CAV_Virtualized)
+			return;
+
+		super.SpawnPatrol();
+		if (!m_Group)
+			return;
+
+		CAV_AIVirtualizationSystem virtualization = CAV_AIVirtualizationSystem.GetInstance();
+		if (virtualization && virtualization.IsActive())
+			virtualization.Adopt(m_Group, this);
+	}
+
+	SCR_AIGroup CAV_GetSpawnedGroup()
+	{
+		return m_Group;
+	}
+
+	// Group is being virtualized: stop listening to it, but the patrol still counts as out
+	void CAV_DetachGroup()
+	{
+		if (m_Group)
+			m_Group.GetOnAgentRemoved().Remove(OnAgentRemoved);
+		m_Group = null;
+		m_CAV_Virtualized = true;
+	}
+
+	// Rehydrated group takes the old one's place, kill detection included
+	void CAV_RestoreGroup(notnull SCR_AIGroup group)
+	{
+		m_Group = group;
+		m_bSpawned = true;
+		m_CAV_Virtualized = false;
+		group.GetOnAgentRemoved().Insert(OnAgentRemoved);
+	}
+
+	// The virtual group is gone for good; the point may spawn again
+	void CAV_ReleaseGroup()
+	{
+		m_CAV_Virtualized = false;
+		m_bSpawned = false;
+	}
+}
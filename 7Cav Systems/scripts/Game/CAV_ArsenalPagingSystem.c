@@ -0,0 +1,546 @@
+// -----------------------------------------------------------------------------
+// CAV_ArsenalPagingSystem.c
+// - Arsenal contents on demand: a client asks for one item category of one
+//   arsenal, the server answers in pages of m_PageSize prefabs
+// - Clients cache each category with its revision; re-opening sends the known
+//   revision and the server answers only if it changed
+// - A revision is a hash of the category's contents, so a view that was dropped
+//   and rebuilt can't hand out a revision a client cached for other contents
+// - Server re-snapshots categories someone is viewing every m_RefreshIntervalS;
+//   on any revision change it pushes added/removed prefabs and cost changes to
+//   those viewers only. Disconnected viewers are pruned on every refresh
+// - Opening an arsenal's storage requests each category it supports; closing
+//   the inventory releases them (see the modded action and menu at the bottom)
+// - Requests travel over the player's own SCR_PlayerController
+//
+// Usage (client UI):
+//   CAV_ArsenalPagingSystem paging = CAV_ArsenalPagingSystem.GetInstance();
+//   paging.GetOnCategoryChanged().Insert(OnArsenalCategory);   // (RplId, int type)
+//   CAV_ArsenalCategory cat = paging.GetCachedCategory(arsenalEntity, SCR_EArsenalItemType.RIFLE);
+// -----------------------------------------------------------------------------
+
+// ---- One category of one arsenal (server snapshot or client cache)
+class CAV_ArsenalCategory
+{
+	int m_Revision;         // content hash, never -1 (-1 = "nothing cached")
+	bool m_Complete;        // client: every page received
+	ref array<string> m_Prefabs = {};
+	ref array<int> m_Costs = {};
+
+	void Clear()
+	{
+		m_Prefabs.Clear();
+		m_Costs.Clear();
+		m_Complete = false;
+	}
+}
+
+// ---- Server: one viewed category of one arsenal and who is viewing it
+class CAV_ArsenalView
+{
+	RplId m_ArsenalId;
+	int m_Type;
+	ref CAV_ArsenalCategory m_Snapshot;
+	ref array<int> m_Viewers = {};
+}
+
+class CAV_ArsenalPagingSystem : GameSystem
+{
+	[Attribute(defvalue: "48", uiwidget: UIWidgets.EditBox, desc: "Prefabs per page", params: "8 256 1")]
+	protected int m_PageSize;
+
+	[Attribute(defvalue: "10", uiwidget: UIWidgets.EditBox, desc: "Seconds between availability re-checks of viewed categories", params: "1 120 1")]
+	protected float m_RefreshIntervalS;
+
+	// --- Server --------------------------------------------------------------
+	protected ref map<string, ref CAV_ArsenalView> m_Views = new map<string, ref CAV_ArsenalView>();
+	protected float m_NextRefreshS;
+
+	// --- Client --------------------------------------------------------------
+	protected ref map<string, ref CAV_ArsenalCategory> m_Cache = new map<string, ref CAV_ArsenalCategory>();
+	protected ref ScriptInvoker m_OnCategoryChanged;
+	protected IEntity m_OpenArsenal;
+	protected ref array<int> m_OpenTypes = {};
+
+	//------------------------------------------------------------------------------------------------
+	override static void InitInfo(WorldSystemInfo outInfo)
+	{
+		outInfo
+			.SetAbstract(false)
+			.SetLocation(ESystemLocation.Both)
+			.AddPoint(ESystemPoint.Frame);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	static CAV_ArsenalPagingSystem GetInstance()
+	{
+		World world = GetGame().GetWorld();
+		if (!world) return null;
+		return CAV_ArsenalPagingSystem.Cast(world.FindSystem(CAV_ArsenalPagingSystem));
+	}
+
+	//------------------------------------------------------------------------------------------------
+	override protected void OnInit()
+	{
+		// Only the server has periodic work, and only while someone is viewing
+		Enable(false);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected static string MakeKey(RplId arsenalId, int type)
+	{
+		return string.Format("%1:%2", arsenalId, type);
+	}
+
+	protected static RplId GetArsenalId(IEntity arsenal)
+	{
+		RplComponent rpl = RplComponent.Cast(arsenal.FindComponent(RplComponent));
+		if (!rpl) return RplId.Invalid();
+		return rpl.Id();
+	}
+
+	protected static SCR_PlayerController GetLocalController()
+	{
+		return SCR_PlayerController.Cast(GetGame().GetPlayerController());
+	}
+
+	// =================================================================================================
+	// CLIENT
+	// =================================================================================================
+
+	// Invoked with (RplId arsenalId, int type) whenever a cached category changes
+	ScriptInvoker GetOnCategoryChanged()
+	{
+		if (!m_OnCategoryChanged)
+			m_OnCategoryChanged = new ScriptInvoker();
+		return m_OnCategoryChanged;
+	}
+
+	CAV_ArsenalCategory GetCachedCategory(notnull IEntity arsenal, int type)
+	{
+		return m_Cache.Get(MakeKey(GetArsenalId(arsenal), type));
+	}
+
+	// Start viewing a category. Returns the cached copy (may be null or stale);
+	// the server answers only if its revision differs from ours.
+	CAV_ArsenalCategory RequestCategory(notnull IEntity arsenal, int type)
+	{
+		RplId arsenalId = GetArsenalId(arsenal);
+		if (!arsenalId.IsValid()) return null;
+
+		CAV_ArsenalCategory cached = m_Cache.Get(MakeKey(arsenalId, type));
+		int knownRevision = -1;
+		if (cached && cached.m_Complete)
+			knownRevision = cached.m_Revision;
+
+		SCR_PlayerController pc = GetLocalController();
+		if (pc)
+			pc.CAV_AskArsenalPage(arsenalId, type, 0, knownRevision);
+
+		CAV_Perf.Count("arsenal.request");
+		return cached;
+	}
+
+	// Stop receiving diffs for a category (menu closed or tab switched)
+	void ReleaseCategory(notnull IEntity arsenal, int type)
+	{
+		SCR_PlayerController pc = GetLocalController();
+		if (pc)
+			pc.CAV_ReleaseArsenalCategory(GetArsenalId(arsenal), type);
+	}
+
+	// Request every category the arsenal supports; the previous one is released
+	void OpenArsenal(notnull IEntity arsenalEntity)
+	{
+		if (m_OpenArsenal == arsenalEntity) return;
+		CloseArsenal();
+
+		SCR_ArsenalComponent arsenal = SCR_ArsenalComponent.Cast(arsenalEntity.FindComponent(SCR_ArsenalComponent));
+		if (!arsenal) return;
+
+		int supported = arsenal.GetSupportedArsenalItemTypes();
+		for (int bit = 0; bit < 31; bit++)
+		{
+			int type = 1 << bit;
+			if (!(supported & type)) continue;
+
+			RequestCategory(arsenalEntity, type);
+			m_OpenTypes.Insert(type);
+		}
+		m_OpenArsenal = arsenalEntity;
+	}
+
+	void CloseArsenal()
+	{
+		if (m_OpenArsenal)
+		{
+			foreach (int type : m_OpenTypes)
+			{
+				ReleaseCategory(m_OpenArsenal, type);
+			}
+		}
+		m_OpenArsenal = null;
+		m_OpenTypes.Clear();
+	}
+
+	//------------------------------------------------------------------------------------------------
+	void ClientOnPage(RplId arsenalId, int type, int revision, int page, int pageCount, array<string> prefabs, array<int> costs)
+	{
+		string key = MakeKey(arsenalId, type);
+		CAV_ArsenalCategory cat = m_Cache.Get(key);
+		if (!cat)
+		{
+			cat = new CAV_ArsenalCategory();
+			m_Cache.Insert(key, cat);
+		}
+
+		// Snapshot changed between pages: start over
+		if (page > 0 && cat.m_Revision != revision)
+		{
+			cat.Clear();
+			SCR_PlayerController pc = GetLocalController();
+			if (pc)
+				pc.CAV_AskArsenalPage(arsenalId, type, 0, -1);
+			return;
+		}
+
+		// First page replaces whatever we had
+		if (page == 0)
+		{
+			cat.Clear();
+			cat.m_Revision = revision;
+		}
+
+		cat.m_Prefabs.InsertAll(prefabs);
+		cat.m_Costs.InsertAll(costs);
+
+		if (page + 1 < pageCount)
+		{
+			SCR_PlayerController nextPc = GetLocalController();
+			if (nextPc)
+				nextPc.CAV_AskArsenalPage(arsenalId, type, page + 1, -1);
+			return;
+		}
+
+		cat.m_Complete = true;
+		if (m_OnCategoryChanged)
+			m_OnCategoryChanged.Invoke(arsenalId, type);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	// "changed" holds prefabs still offered at a new cost
+	void ClientOnDiff(RplId arsenalId, int type, int baseRevision, int revision, array<string> removed, array<string> added, array<int> addedCosts, array<string> changed, array<int> changedCosts)
+	{
+		CAV_ArsenalCategory cat = m_Cache.Get(MakeKey(arsenalId, type));
+		if (!cat) return;
+
+		// Missed a step: drop the copy and refetch from page 0
+		if (cat.m_Revision != baseRevision || !cat.m_Complete)
+		{
+			cat.Clear();
+			SCR_PlayerController pc = GetLocalController();
+			if (pc)
+				pc.CAV_AskArsenalPage(arsenalId, type, 0, -1);
+			return;
+		}
+
+		foreach (string prefab : removed)
+		{
+			int idx = cat.m_Prefabs.Find(prefab);
+			if (idx == -1) continue;
+			cat.m_Prefabs.RemoveOrdered(idx);
+			cat.m_Costs.RemoveOrdered(idx);
+		}
+
+		cat.m_Prefabs.InsertAll(added);
+		cat.m_Costs.InsertAll(addedCosts);
+
+		foreach (int i, string prefab : changed)
+		{
+			int at = cat.m_Prefabs.Find(prefab);
+			if (at != -1)
+				cat.m_Costs[at] = changedCosts[i];
+		}
+		cat.m_Revision = revision;
+
+		if (m_OnCategoryChanged)
+			m_OnCategoryChanged.Invoke(arsenalId, type);
+	}
+
+	// =================================================================================================
+	// SERVER
+	// =================================================================================================
+
+	void ServerOnPageRequest(notnull SCR_PlayerController pc, RplId arsenalId, int type, int page, int knownRevision)
+	{
+		string key = MakeKey(arsenalId, type);
+		CAV_ArsenalView view = m_Views.Get(key);
+		if (!view)
+		{
+			view = new CAV_ArsenalView();
+			view.m_ArsenalId = arsenalId;
+			view.m_Type = type;
+			view.m_Snapshot = new CAV_ArsenalCategory();
+			if (!BuildSnapshot(arsenalId, type, view.m_Snapshot)) return;
+			m_Views.Insert(key, view);
+		}
+
+		if (!view.m_Viewers.Contains(pc.GetPlayerId()))
+			view.m_Viewers.Insert(pc.GetPlayerId());
+		Enable(true);
+
+		CAV_ArsenalCategory snap = view.m_Snapshot;
+
+		// Client is up to date; diffs will follow if anything changes
+		if (page == 0 && knownRevision == snap.m_Revision)
+		{
+			CAV_Perf.Count("arsenal.not_modified");
+			return;
+		}
+
+		int total = snap.m_Prefabs.Count();
+		float pageSize = m_PageSize;
+		int pageCount = Math.Max(1, Math.Ceil(total / pageSize));
+		if (page < 0 || page >= pageCount) return;
+
+		int first = page * m_PageSize;
+		int last = Math.Min(first + m_PageSize, total);
+
+		array<string> prefabs = {};
+		array<int> costs = {};
+		for (int i = first; i < last; i++)
+		{
+			prefabs.Insert(snap.m_Prefabs[i]);
+			costs.Insert(snap.m_Costs[i]);
+		}
+
+		pc.CAV_SendArsenalPage(arsenalId, type, snap.m_Revision, page, pageCount, prefabs, costs);
+		CAV_Perf.Count("arsenal.pages_sent");
+		CAV_Perf.Count("arsenal.items_sent", prefabs.Count());
+	}
+
+	//------------------------------------------------------------------------------------------------
+	void ServerOnRelease(int playerId, RplId arsenalId, int type)
+	{
+		string key = MakeKey(arsenalId, type);
+		CAV_ArsenalView view = m_Views.Get(key);
+		if (!view) return;
+
+		view.m_Viewers.RemoveItem(playerId);
+		if (view.m_Viewers.IsEmpty())
+			m_Views.Remove(key);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	// Items of one type the arsenal currently offers, in catalog order
+	protected bool BuildSnapshot(RplId arsenalId, int type, notnull CAV_ArsenalCategory outCat)
+	{
+		RplComponent rpl = RplComponent.Cast(Replication.FindItem(arsenalId));
+		if (!rpl) return false;
+
+		SCR_ArsenalComponent arsenal = SCR_ArsenalComponent.Cast(rpl.GetEntity().FindComponent(SCR_ArsenalComponent));
+		if (!arsenal) return false;
+
+		array<SCR_ArsenalItem> items = {};
+		arsenal.GetFilteredArsenalItems(items);
+
+		outCat.Clear();
+		int hash = type;
+		foreach (SCR_ArsenalItem item : items)
+		{
+			if (!(item.GetItemType() & type)) continue;
+
+			string prefab = item.GetItemResourceName();
+			int cost = item.GetSupplyCost(SCR_EArsenalSupplyCostType.DEFAULT);
+			outCat.m_Prefabs.Insert(prefab);
+			outCat.m_Costs.Insert(cost);
+			hash = hash * 31 + prefab.Hash();
+			hash = hash * 31 + cost;
+		}
+
+		if (hash == -1)
+			hash = 0;
+		outCat.m_Revision = hash;
+		return true;
+	}
+
+	//------------------------------------------------------------------------------------------------
+	override protected void OnUpdate(ESystemPoint point)
+	{
+		if (m_Views.IsEmpty())
+		{
+			Enable(false);
+			return;
+		}
+
+		float nowS = GetWorld().GetWorldTime() * 0.001;
+		if (nowS < m_NextRefreshS) return;
+		m_NextRefreshS = nowS + m_RefreshIntervalS;
+
+		CAV_PerfScope perfScope = CAV_Perf.Scope("arsenal.refresh_ms");
+
+		array<string> keys = {};
+		foreach (string key, CAV_ArsenalView view : m_Views)
+		{
+			keys.Insert(key);
+		}
+
+		foreach (string key : keys)
+		{
+			if (!RefreshView(m_Views.Get(key)))
+				m_Views.Remove(key);
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------
+	// False when the view should be dropped (arsenal gone or nobody left)
+	protected bool RefreshView(CAV_ArsenalView view)
+	{
+		PlayerManager pm = GetGame().GetPlayerManager();
+		array<int> viewers = view.m_Viewers;
+		for (int v = viewers.Count() - 1; v >= 0; v--)
+		{
+			if (!pm.GetPlayerController(viewers[v]))
+				viewers.Remove(v);
+		}
+		if (viewers.IsEmpty()) return false;
+
+		CAV_ArsenalCategory snap = view.m_Snapshot;
+		CAV_ArsenalCategory fresh = new CAV_ArsenalCategory();
+		if (!BuildSnapshot(view.m_ArsenalId, view.m_Type, fresh))
+			return false;
+
+		if (fresh.m_Revision == snap.m_Revision) return true;
+
+		array<string> removed = {};
+		foreach (string prefab : snap.m_Prefabs)
+		{
+			if (!fresh.m_Prefabs.Contains(prefab))
+				removed.Insert(prefab);
+		}
+
+		array<string> added = {};
+		array<int> addedCosts = {};
+		array<string> changed = {};
+		array<int> changedCosts = {};
+		foreach (int i, string prefab : fresh.m_Prefabs)
+		{
+			int old = snap.m_Prefabs.Find(prefab);
+			if (old == -1)
+			{
+				added.Insert(prefab);
+				addedCosts.Insert(fresh.m_Costs[i]);
+			}
+			else if (snap.m_Costs[old] != fresh.m_Costs[i])
+			{
+				changed.Insert(prefab);
+				changedCosts.Insert(fresh.m_Costs[i]);
+			}
+		}
+
+		// Sent even when only the order changed, so clients pick up the new revision
+		int baseRevision = snap.m_Revision;
+		view.m_Snapshot = fresh;
+
+		foreach (int playerId : viewers)
+		{
+			SCR_PlayerController pc = SCR_PlayerController.Cast(pm.GetPlayerController(playerId));
+			if (pc)
+				pc.CAV_SendArsenalDiff(view.m_ArsenalId, view.m_Type, baseRevision, fresh.m_Revision, removed, added, addedCosts, changed, changedCosts);
+		}
+
+		CAV_Perf.Count("arsenal.diffs_sent", viewers.Count());
+		return true;
+	}
+}
+
+// ---- Transport: the player's own controller is the only entity a client may RPC through
+modded class SCR_PlayerController
+{
+	//------------------------------------------------------------------------------------------------
+	void CAV_AskArsenalPage(RplId arsenalId, int type, int page, int knownRevision)
+	{
+		Rpc(CAV_RpcAsk_ArsenalPage, arsenalId, type, page, knownRevision);
+	}
+
+	[RplRpc(RplChannel.Reliable, RplRcver.Server)]
+	protected void CAV_RpcAsk_ArsenalPage(RplId arsenalId, int type, int page, int knownRevision)
+	{
+		CAV_ArsenalPagingSystem paging = CAV_ArsenalPagingSystem.GetInstance();
+		if (paging)
+			paging.ServerOnPageRequest(this, arsenalId, type, page, knownRevision);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	void CAV_ReleaseArsenalCategory(RplId arsenalId, int type)
+	{
+		Rpc(CAV_RpcAsk_ReleaseArsenalCategory, arsenalId, type);
+	}
+
+	[RplRpc(RplChannel.Reliable, RplRcver.Server)]
+	protected void CAV_RpcAsk_ReleaseArsenalCategory(RplId arsenalId, int type)
+	{
+		CAV_ArsenalPagingSystem paging = CAV_ArsenalPagingSystem.GetInstance();
+		if (paging)
+			paging.ServerOnRelease(GetPlayerId(), arsenalId, type);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	void CAV_SendArsenalPage(RplId arsenalId, int type, int revision, int page, int pageCount, array<string> prefabs, array<int> costs)
+	{
+		Rpc(CAV_RpcDo_ArsenalPage, arsenalId, type, revision, page, pageCount, prefabs, costs);
+	}
+
+	[RplRpc(RplChannel.Reliable, RplRcver.Owner)]
+	protected void CAV_RpcDo_ArsenalPage(RplId arsenalId, int type, int revision, int page, int pageCount, array<string> prefabs, array<int> costs)
+	{
+		CAV_ArsenalPagingSystem paging = CAV_ArsenalPagingSystem.GetInstance();
+		if (paging)
+			paging.ClientOnPage(arsenalId, type, revision, page, pageCount, prefabs, costs);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	void CAV_SendArsenalDiff(RplId arsenalId, int type, int baseRevision, int revision, array<string> removed, array<string> added, array<int> addedCosts, array<string> changed, array<int> changedCosts)
+	{
+		Rpc(CAV_RpcDo_ArsenalDiff, arsenalId, type, baseRevision, revision, removed, added, addedCosts, changed, changedCosts);
+	}
+
+	[RplRpc(RplChannel.Reliable, RplRcver.Owner)]
+	protected void CAV_RpcDo_ArsenalDiff(RplId arsenalId, int type, int baseRevision, int revision, array<string> removed, array<string> added, array<int> addedCosts, array<string> changed, array<int> changedCosts)
+	{
+		CAV_ArsenalPagingSystem paging = CAV_ArsenalPagingSystem.GetInstance();
+		if (paging)
+			paging.ClientOnDiff(arsenalId, type, baseRevision, revision, removed, added, addedCosts, changed, changedCosts);
+	}
+}
+
+// ---- Opening an arsenal's storage starts viewing its categories
+modded class SCR_OpenStorageAction
+{
+	override protected void PerformActionInternal(SCR_InventoryStorageManagerComponent manager, IEntity pOwnerEntity, IEntity pUserEntity)
+	{
+		super.PerformActionInternal(manager, pOwnerEntity, pUserEntity);
+
+		if (pUserEntity != SCR_PlayerController.GetLocalControlledEntity())
+			return;
+		if (!pOwnerEntity || !pOwnerEntity.FindComponent(SCR_ArsenalComponent))
+			return;
+
+		CAV_ArsenalPagingSystem paging = CAV_ArsenalPagingSystem.GetInstance();
+		if (paging)
+			paging.OpenArsenal(pOwnerEntity);
+	}
+}
+
+// ---- Closing the inventory stops the diffs
+modded class SCR_InventoryMenuUI
+{
+	override void OnMenuClose()
+	{
+		super.OnMenuClose();
+
+		CAV_ArsenalPagingSystem paging = CAV_ArsenalPagingSystem.GetInstance();
+		if (paging)
+			paging.CloseArsenal();
+	}
+}
@@ -0,0 +1,434 @@
+// -----------------------------------------------------------------------------
+// CAV_BenchmarkSystem.c
+// - Headless load + soak benchmark, off unless the server is started with
+//   -cavBench <scenario name> (see misc/benchmark/run_benchmark.sh)
+// - Scenarios are listed on the system in ChimeraSystemsConfig.conf: stand-in
+//   player count, warm-up and soak length per mission
+// - Stand-ins are inert characters walking around spawn points; they are
+//   registered as a player position source with CAV_SpatialGrid, so patrols,
+//   virtualization, seizing etc. wake up as they would with people on
+// - Records the time from system init to the first simulated frame (the part
+//   of world load after systems come up), entity/character/vehicle/AI counts,
+//   script memory
+//   and frame-time percentiles over the soak, then writes one JSON report to
+//   $profile:7cav_bench_<scenario>.json and closes the game
+// - Stand-ins that get killed are replaced during the soak too, and the live
+//   count is sampled with the rest, so the simulated load doesn't quietly shrink
+// - The frame that pays for a sample's whole-world query is left out of the
+//   frame-time series
+// -----------------------------------------------------------------------------
+
+[BaseContainerProps()]
+class CAV_BenchmarkScenario
+{
+	[Attribute(defvalue: "", uiwidget: UIWidgets.EditBox, desc: "Name passed as -cavBench <name>")]
+	string m_Name;
+
+	[Attribute(defvalue: "", uiwidget: UIWidgets.ResourcePickerThumbnail, desc: "Mission header the scenario is meant for (reported only)", params: "conf")]
+	ResourceName m_Mission;
+
+	[Attribute(defvalue: "128", uiwidget: UIWidgets.EditBox, desc: "Scripted stand-in players", params: "0 256 1")]
+	int m_StandInCount;
+
+	[Attribute(defvalue: "120", uiwidget: UIWidgets.EditBox, desc: "Seconds after load before measuring (stand-ins spawn here)", params: "0 3600 1")]
+	float m_WarmupS;
+
+	[Attribute(defvalue: "600", uiwidget: UIWidgets.EditBox, desc: "Measured soak length (s)", params: "10 86400 1")]
+	float m_SoakS;
+}
+
+enum CAV_EBenchmarkPhase
+{
+	LOADING,
+	WARMUP,
+	SOAK,
+	DONE
+}
+
+class CAV_BenchmarkSystem : GameSystem
+{
+	[Attribute(desc: "Benchmark scenarios, selected by -cavBench <name>")]
+	protected ref array<ref CAV_BenchmarkScenario> m_Scenarios;
+
+	[Attribute(defvalue: "{26A9756790131354}Prefabs/Characters/Factions/BLUFOR/US_Army/Character_US_Rifleman.et", uiwidget: UIWidgets.ResourcePickerThumbnail, desc: "Stand-in player prefab", params: "et")]
+	protected ResourceName m_StandInPrefab;
+
+	[Attribute(defvalue: "400", uiwidget: UIWidgets.EditBox, desc: "Stand-ins roam this far around their spawn point (m)", params: "10 5000 10")]
+	protected float m_RoamRadius;
+
+	[Attribute(defvalue: "5", uiwidget: UIWidgets.EditBox, desc: "Stand-in movement speed (m/s)", params: "0.5 40 0.5")]
+	protected float m_RoamSpeed;
+
+	[Attribute(defvalue: "4", uiwidget: UIWidgets.EditBox, desc: "Stand-ins spawned per frame during warm-up", params: "1 64 1")]
+	protected int m_StandInsPerFrame;
+
+	[Attribute(defvalue: "30", uiwidget: UIWidgets.EditBox, desc: "Seconds between entity/memory samples during the soak", params: "1 600 1")]
+	protected float m_SampleIntervalS;
+
+	// --- State ---------------------------------------------------------------
+	protected CAV_BenchmarkScenario m_Scenario;
+	protected CAV_EBenchmarkPhase m_Phase;
+	protected int m_InitTickMs;
+	protected int m_InitToFirstFrameMs;
+	protected int m_LastTickMs;
+	protected float m_PhaseEndS;
+	protected float m_NextSampleS;
+	protected bool m_SkipFrameTime;
+
+	protected ref array<IEntity> m_StandIns = {};
+	protected ref array<vector> m_StandInAnchors = {};
+	protected ref array<vector> m_StandInTargets = {};
+
+	protected ref array<float> m_FrameMs = {};
+	protected ref array<int> m_SampleEntities = {};
+	protected ref array<int> m_SampleCharacters = {};
+	protected ref array<int> m_SampleVehicles = {};
+	protected ref array<int> m_SampleAgents = {};
+	protected ref array<int> m_SampleMemoryKB = {};
+	protected ref array<int> m_SampleStandIns = {};
+
+	protected int m_QueryEntities;
+	protected int m_QueryCharacters;
+	protected int m_QueryVehicles;
+
+	//------------------------------------------------------------------------------------------------
+	override static void InitInfo(WorldSystemInfo outInfo)
+	{
+		outInfo
+			.SetAbstract(false)
+			.SetLocation(ESystemLocation.Server)
+			.AddPoint(ESystemPoint.Frame);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	static CAV_BenchmarkSystem GetInstance()
+	{
+		World world = GetGame().GetWorld();
+		if (!world) return null;
+		return CAV_BenchmarkSystem.Cast(world.FindSystem(CAV_BenchmarkSystem));
+	}
+
+	//------------------------------------------------------------------------------------------------
+	override protected void OnInit()
+	{
+		string name;
+		if (!System.GetCLIParam("cavBench", name) || !m_Scenarios)
+		{
+			Enable(false);
+			return;
+		}
+
+		foreach (CAV_BenchmarkScenario scenario : m_Scenarios)
+		{
+			if (scenario.m_Name == name)
+				m_Scenario = scenario;
+		}
+
+		if (!m_Scenario)
+		{
+			PrintFormat("[CAV_Benchmark] Unknown scenario '%1'", name, level: LogLevel.ERROR);
+			Enable(false);
+			return;
+		}
+
+		m_InitTickMs = System.GetTickCount();
+		m_Phase = CAV_EBenchmarkPhase.LOADING;
+		CAV_SpatialGrid.GetOnGatherPlayerPositions().Insert(AppendStandInPositions);
+		PrintFormat("[CAV_Benchmark] Scenario %1: %2 stand-ins, %3 s warm-up, %4 s soak", m_Scenario.m_Name, m_Scenario.m_StandInCount, m_Scenario.m_WarmupS, m_Scenario.m_SoakS);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	override protected void OnCleanup()
+	{
+		CAV_SpatialGrid.GetOnGatherPlayerPositions().Remove(AppendStandInPositions);
+
+		foreach (IEntity standIn : m_StandIns)
+		{
+			if (standIn)
+				SCR_EntityHelper.DeleteEntityAndChildren(standIn);
+		}
+		m_StandIns.Clear();
+	}
+
+	// Stand-in positions, appended to the real player positions
+	void AppendStandInPositions(notnull array<vector> outPositions)
+	{
+		foreach (IEntity standIn : m_StandIns)
+		{
+			if (standIn)
+				outPositions.Insert(standIn.GetOrigin());
+		}
+	}
+
+	// --- Frame update --------------------------------------------------------
+	override protected void OnUpdate(ESystemPoint point)
+	{
+		int tickMs = System.GetTickCount();
+		float nowS = GetWorld().GetWorldTime() * 0.001;
+
+		switch (m_Phase)
+		{
+			case CAV_EBenchmarkPhase.LOADING:
+			{
+				// First frame: everything the world loads synchronously after system init is done
+				m_InitToFirstFrameMs = tickMs - m_InitTickMs;
+				m_Phase = CAV_EBenchmarkPhase.WARMUP;
+				m_PhaseEndS = nowS + m_Scenario.m_WarmupS;
+				PrintFormat("[CAV_Benchmark] First frame %1 ms after system init", m_InitToFirstFrameMs);
+				break;
+			}
+
+			case CAV_EBenchmarkPhase.WARMUP:
+			{
+				SpawnStandIns();
+				MoveStandIns(tickMs - m_LastTickMs);
+
+				if (nowS >= m_PhaseEndS)
+				{
+					m_Phase = CAV_EBenchmarkPhase.SOAK;
+					m_PhaseEndS = nowS + m_Scenario.m_SoakS;
+					m_NextSampleS = nowS;
+					PrintFormat("[CAV_Benchmark] Soak started with %1/%2 stand-ins", m_StandIns.Count(), m_Scenario.m_StandInCount);
+				}
+				break;
+			}
+
+			case CAV_EBenchmarkPhase.SOAK:
+			{
+				// The previous frame ran a sample; its cost isn't gameplay
+				if (m_SkipFrameTime)
+					m_SkipFrameTime = false;
+				else
+					m_FrameMs.Insert(tickMs - m_LastTickMs);
+
+				SpawnStandIns();
+				MoveStandIns(tickMs - m_LastTickMs);
+
+				if (nowS >= m_NextSampleS)
+				{
+					m_NextSampleS = nowS + m_SampleIntervalS;
+					Sample();
+					m_SkipFrameTime = true;
+				}
+
+				if (nowS >= m_PhaseEndS)
+				{
+					Sample();
+					WriteReport();
+					m_Phase = CAV_EBenchmarkPhase.DONE;
+					GetGame().RequestClose();
+				}
+				break;
+			}
+		}
+
+		m_LastTickMs = tickMs;
+	}
+
+	// --- Stand-ins -----------------------------------------------------------
+	protected void SpawnStandIns()
+	{
+		PruneStandIns();
+
+		int missing = m_Scenario.m_StandInCount - m_StandIns.Count();
+		if (missing <= 0) return;
+
+		array<SCR_SpawnPoint> spawnPoints = SCR_SpawnPoint.GetSpawnPoints();
+		if (!spawnPoints || spawnPoints.IsEmpty()) return;
+
+		Resource res = Resource.Load(m_StandInPrefab);
+		if (!res || !res.IsValid()) return;
+
+		int count = Math.Min(missing, m_StandInsPerFrame);
+		for (int i = 0; i < count; i++)
+		{
+			// Round-robin over spawn points, like players spreading over deployments
+			SCR_SpawnPoint sp = spawnPoints[m_StandIns.Count() % spawnPoints.Count()];
+			vector anchor = sp.GetOrigin();
+
+			EntitySpawnParams params = new EntitySpawnParams();
+			params.TransformMode = ETransformMode.WORLD;
+			params.Transform[3] = OnSurface(anchor);
+
+			IEntity standIn = GetGame().SpawnEntityPrefab(res, GetWorld(), params);
+			if (!standIn) continue;
+
+			m_StandIns.Insert(standIn);
+			m_StandInAnchors.Insert(anchor);
+			m_StandInTargets.Insert(PickTarget(anchor));
+		}
+	}
+
+	// Killed or deleted stand-ins make room for replacements; bodies are left to the garbage rules
+	protected void PruneStandIns()
+	{
+		for (int i = m_StandIns.Count() - 1; i >= 0; i--)
+		{
+			if (IsAlive(m_StandIns[i])) continue;
+
+			m_StandIns.Remove(i);
+			m_StandInAnchors.Remove(i);
+			m_StandInTargets.Remove(i);
+		}
+	}
+
+	protected static bool IsAlive(IEntity standIn)
+	{
+		ChimeraCharacter character = ChimeraCharacter.Cast(standIn);
+		if (!character) return standIn != null;
+
+		CharacterControllerComponent ctrl = character.GetCharacterController();
+		return !ctrl || !ctrl.IsDead();
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected void MoveStandIns(int dtMs)
+	{
+		float step = m_RoamSpeed * dtMs * 0.001;
+
+		foreach (int i, IEntity standIn : m_StandIns)
+		{
+			if (!standIn) continue;
+
+			vector pos = standIn.GetOrigin();
+			vector toTarget = m_StandInTargets[i] - pos;
+			toTarget[1] = 0;
+			float dist = toTarget.Length();
+
+			if (dist <= step)
+			{
+				m_StandInTargets[i] = PickTarget(m_StandInAnchors[i]);
+				continue;
+			}
+
+			standIn.SetOrigin(OnSurface(pos + toTarget * (step / dist)));
+			standIn.Update();
+		}
+	}
+
+	protected vector PickTarget(vector anchor)
+	{
+		float angle = Math.RandomFloat(0, Math.PI2);
+		float dist = Math.RandomFloat(0, m_RoamRadius);
+		return anchor + Vector(Math.Cos(angle) * dist, 0, Math.Sin(angle) * dist);
+	}
+
+	protected vector OnSurface(vector pos)
+	{
+		pos[1] = GetWorld().GetSurfaceY(pos[0], pos[2]);
+		return pos;
+	}
+
+	// --- Measurement ---------------------------------------------------------
+	protected void Sample()
+	{
+		m_QueryEntities = 0;
+		m_QueryCharacters = 0;
+		m_QueryVehicles = 0;
+
+		vector mins, maxs;
+		GetWorld().GetBoundBox(mins, maxs);
+		GetWorld().QueryEntitiesByAABB(mins, maxs, CountEntity, null, EQueryEntitiesFlags.ALL);
+
+		m_SampleEntities.Insert(m_QueryEntities);
+		m_SampleCharacters.Insert(m_QueryCharacters);
+		m_SampleVehicles.Insert(m_QueryVehicles);
+
+		int agents = 0;
+		AIWorld aiWorld = GetGame().GetAIWorld();
+		if (aiWorld)
+		{
+			array<AIAgent> agentList = {};
+			aiWorld.GetAIAgents(agentList);
+			agents = agentList.Count();
+		}
+		m_SampleAgents.Insert(agents);
+		m_SampleMemoryKB.Insert(System.MemoryAllocationKB());
+
+		int standIns = 0;
+		foreach (IEntity standIn : m_StandIns)
+		{
+			if (IsAlive(standIn))
+				standIns++;
+		}
+		m_SampleStandIns.Insert(standIns);
+	}
+
+	protected bool CountEntity(IEntity ent)
+	{
+		m_QueryEntities++;
+		if (ChimeraCharacter.Cast(ent))
+			m_QueryCharacters++;
+		else if (Vehicle.Cast(ent))
+			m_QueryVehicles++;
+		return true;
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected void WriteReport()
+	{
+		array<float> sorted = {};
+		sorted.Copy(m_FrameMs);
+		sorted.Sort();
+
+		string json = "{";
+		json += string.Format("\"scenario\":\"%1\",\"mission\":\"%2\",\"stand_ins\":%3,", m_Scenario.m_Name, m_Scenario.m_Mission, m_StandIns.Count());
+		json += string.Format("\"init_to_first_frame_ms\":%1,\"warmup_s\":%2,\"soak_s\":%3,\"frames\":%4,", m_InitToFirstFrameMs, m_Scenario.m_WarmupS, m_Scenario.m_SoakS, sorted.Count());
+
+		// Frame-time percentiles; FPS at p50/p95/p99 frame time is what "1% low" means
+		json += "\"frame_ms\":{";
+		json += string.Format("\"p50\":%1,\"p95\":%2,\"p99\":%3,\"max\":%4", Percentile(sorted, 0.5), Percentile(sorted, 0.95), Percentile(sorted, 0.99), Percentile(sorted, 1));
+		json += "},\"fps\":{";
+		json += string.Format("\"p50\":%1,\"p5\":%2,\"p1\":%3", ToFps(Percentile(sorted, 0.5)), ToFps(Percentile(sorted, 0.95)), ToFps(Percentile(sorted, 0.99)));
+		json += "},";
+
+		json += SeriesJson("entities", m_SampleEntities) + ",";
+		json += SeriesJson("characters", m_SampleCharacters) + ",";
+		json += SeriesJson("vehicles", m_SampleVehicles) + ",";
+		json += SeriesJson("ai_agents", m_SampleAgents) + ",";
+		json += SeriesJson("memory_kb", m_SampleMemoryKB) + ",";
+		json += SeriesJson("live_stand_ins", m_SampleStandIns);
+		json += "}";
+
+		string path = string.Format("$profile:7cav_bench_%1.json", m_Scenario.m_Name);
+		FileHandle fh = FileIO.OpenFile(path, FileMode.WRITE);
+		if (fh)
+		{
+			fh.WriteLine(json);
+			fh.Close();
+			PrintFormat("[CAV_Benchmark] Report written to %1", path);
+		}
+		else
+			PrintFormat("[CAV_Benchmark] Could not open %1 for writing", path, level: LogLevel.ERROR);
+	}
+
+	protected static float Percentile(notnull array<float> sorted, float p)
+	{
+		if (sorted.IsEmpty()) return 0;
+		int i = Math.ClampInt(Math.Ceil(p * sorted.Count()) - 1, 0, sorted.Count() - 1);
+		return sorted[i];
+	}
+
+	protected static float ToFps(float frameMs)
+	{
+		if (frameMs <= 0) return 0;
+		return 1000 / frameMs;
+	}
+
+	protected static string SeriesJson(string name, notnull array<int> values)
+	{
+		int min, max, last;
+		if (!values.IsEmpty())
+		{
+			min = values[0];
+			max = values[0];
+			last = values[values.Count() - 1];
+			foreach (int v : values)
+			{
+				min = Math.Min(min, v);
+				max = Math.Max(max, v);
+			}
+		}
+		return string.Format("\"%1\":{\"min\":%2,\"max\":%3,\"last\":%4}", name, min, max, last);
+	}
+}
@@ -0,0 +1,291 @@
+// -----------------------------------------------------------------------------
+// CAV_CompositionSpawnSystem.c
+// - Linked compositions (SCR_EditorLinkComponent, used by the GM slot
+//   compositions such as the helipads and vehicle service points) no longer
+//   spawn every entry in the frame the root appears
+// - Up front, every entry is expanded into spawn jobs and validated as a
+//   whole (water, vehicle slope); a failed composition spawns nothing and its
+//   root is removed
+// - Jobs are spawned under a per-frame budget: static props first, then
+//   vehicles, then AI
+// - Spawned entries stay top-level entities in the world and are registered
+//   under the composition through the vanilla editable parent, so vehicles
+//   and AI simulate on their own and the GM manages them as children
+// -----------------------------------------------------------------------------
+
+enum CAV_ECompositionJobKind
+{
+	STATIC,
+	VEHICLE,
+	AI
+}
+
+class CAV_CompositionJob
+{
+	ResourceName m_Prefab;
+	vector m_Transform[4];
+	CAV_ECompositionJobKind m_Kind;
+	IEntity m_Root;        // composition root; job is dropped if it's gone
+}
+
+class CAV_CompositionSpawnSystem : GameSystem
+{
+	[Attribute(defvalue: "1", uiwidget: UIWidgets.CheckBox, desc: "Spawn linked compositions in budgeted batches")]
+	protected bool m_Active;
+
+	[Attribute(defvalue: "4", uiwidget: UIWidgets.EditBox, desc: "Max entities spawned per frame", params: "1 64 1")]
+	protected int m_MaxSpawnsPerFrame;
+
+	[Attribute(defvalue: "3", uiwidget: UIWidgets.EditBox, desc: "Max milliseconds of composition spawning per frame", params: "1 50 1")]
+	protected int m_MaxFrameTimeMs;
+
+	[Attribute(defvalue: "25", uiwidget: UIWidgets.EditBox, desc: "Max terrain slope under a vehicle (deg)", params: "0 90 1")]
+	protected float m_MaxVehicleSlopeDeg;
+
+	[Attribute(defvalue: "0.5", uiwidget: UIWidgets.EditBox, desc: "Entries deeper than this below sea level are rejected (m)", params: "0 50 0.1")]
+	protected float m_MaxSubmersion;
+
+	// --- State ---------------------------------------------------------------
+	// One FIFO per kind; a kind is only served once the ones before it are empty
+	protected ref array<ref array<ref CAV_CompositionJob>> m_Queues = {};
+	protected ref array<ref CAV_CompositionJob> m_Expanded = {};
+
+	//------------------------------------------------------------------------------------------------
+	override static void InitInfo(WorldSystemInfo outInfo)
+	{
+		outInfo
+			.SetAbstract(false)
+			.SetLocation(ESystemLocation.Server)
+			.AddPoint(ESystemPoint.Frame);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	static CAV_CompositionSpawnSystem GetInstance()
+	{
+		World world = GetGame().GetWorld();
+		if (!world) return null;
+		return CAV_CompositionSpawnSystem.Cast(world.FindSystem(CAV_CompositionSpawnSystem));
+	}
+
+	//------------------------------------------------------------------------------------------------
+	override protected void OnInit()
+	{
+		array<int> kinds = {};
+		SCR_Enum.GetEnumValues(CAV_ECompositionJobKind, kinds);
+		foreach (int kind : kinds)
+		{
+			m_Queues.Insert(new array<ref CAV_CompositionJob>());
+		}
+
+		Enable(false);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	bool IsActive()
+	{
+		return m_Active;
+	}
+
+	// --- Intake --------------------------------------------------------------
+	// Expand, validate and queue a composition. False if it failed validation;
+	// nothing is queued in that case.
+	bool Submit(notnull IEntity root, notnull array<ResourceName> prefabs, notnull array<vector> localPositions, notnull array<vector> localAngles)
+	{
+		m_Expanded.Clear();
+
+		vector rootTransform[4];
+		root.GetWorldTransform(rootTransform);
+
+		foreach (int i, ResourceName prefab : prefabs)
+		{
+			vector local[4];
+			EntityAnglesToMatrix(localAngles[i], local);
+			local[3] = localPositions[i];
+
+			vector world[4];
+			Math3D.MatrixMultiply4(rootTransform, local, world);
+			AddJob(prefab, world, root);
+		}
+
+		foreach (CAV_CompositionJob job : m_Expanded)
+		{
+			if (!Validate(job))
+			{
+				PrintFormat("[CAV_CompositionSpawn] %1 rejected: %2 cannot be placed at %3", GetPrefabName(root), job.m_Prefab, job.m_Transform[3], level: LogLevel.WARNING);
+				CAV_Perf.Count("composition.rejected");
+				m_Expanded.Clear();
+				return false;
+			}
+		}
+
+		foreach (CAV_CompositionJob job : m_Expanded)
+		{
+			m_Queues[job.m_Kind].Insert(job);
+		}
+
+		CAV_Perf.Count("composition.jobs", m_Expanded.Count());
+		m_Expanded.Clear();
+		Enable(true);
+		return true;
+	}
+
+	//------------------------------------------------------------------------------------------------
+	// One job per entry; entries are spawned from their own prefab so every
+	// override the prefab makes on its children is kept
+	protected void AddJob(ResourceName prefab, vector transform[4], IEntity root)
+	{
+		Resource res = Resource.Load(prefab);
+		if (!res || !res.IsValid()) return;
+
+		IEntitySource source = res.GetResource().ToEntitySource();
+		if (!source) return;
+
+		CAV_CompositionJob job = new CAV_CompositionJob();
+		job.m_Prefab = prefab;
+		for (int i = 0; i < 4; i++)
+			job.m_Transform[i] = transform[i];
+		job.m_Kind = Classify(source);
+		job.m_Root = root;
+		m_Expanded.Insert(job);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	// Entity angles are stored as (x = pitch, y = yaw, z = roll); AnglesToMatrix wants yaw, pitch, roll
+	protected static void EntityAnglesToMatrix(vector angles, out vector transform[4])
+	{
+		Math3D.AnglesToMatrix(Vector(angles[1], angles[0], angles[2]), transform);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected bool Validate(CAV_CompositionJob job)
+	{
+		vector pos = job.m_Transform[3];
+		BaseWorld world = GetWorld();
+
+		if (pos[1] < world.GetOceanBaseHeight() - m_MaxSubmersion)
+			return false;
+
+		if (job.m_Kind == CAV_ECompositionJobKind.VEHICLE)
+		{
+			vector normal = SCR_TerrainHelper.GetTerrainNormal(pos, world);
+			float slopeDeg = Math.Acos(Math.Clamp(normal[1], -1, 1)) * Math.RAD2DEG;
+			if (slopeDeg > m_MaxVehicleSlopeDeg)
+				return false;
+		}
+
+		return true;
+	}
+
+	protected static CAV_ECompositionJobKind Classify(IEntitySource source)
+	{
+		typename type = source.GetClassName().ToType();
+		if (!type)
+			return CAV_ECompositionJobKind.STATIC;
+		if (type.IsInherited(Vehicle))
+			return CAV_ECompositionJobKind.VEHICLE;
+		if (type.IsInherited(SCR_AIGroup) || type.IsInherited(ChimeraCharacter))
+			return CAV_ECompositionJobKind.AI;
+		return CAV_ECompositionJobKind.STATIC;
+	}
+
+	// --- Frame update --------------------------------------------------------
+	override protected void OnUpdate(ESystemPoint point)
+	{
+		CAV_PerfScope perfScope = CAV_Perf.Scope("composition.frame_ms");
+
+		int startMs = System.GetTickCount();
+		int done = 0;
+		int pending = 0;
+
+		foreach (array<ref CAV_CompositionJob> queue : m_Queues)
+		{
+			while (!queue.IsEmpty() && done < m_MaxSpawnsPerFrame && System.GetTickCount() - startMs < m_MaxFrameTimeMs)
+			{
+				CAV_CompositionJob job = queue[0];
+				queue.RemoveOrdered(0);
+
+				// GM deleted the composition while it was streaming in
+				if (!job.m_Root) continue;
+
+				if (SpawnJob(job))
+					done++;
+			}
+
+			pending += queue.Count();
+
+			// Later kinds wait for earlier ones
+			if (!queue.IsEmpty())
+				break;
+		}
+
+		CAV_Perf.Count("composition.spawned", done);
+		if (pending == 0)
+			Enable(false);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected bool SpawnJob(CAV_CompositionJob job)
+	{
+		Resource res = Resource.Load(job.m_Prefab);
+		if (!res || !res.IsValid()) return false;
+
+		EntitySpawnParams params = new EntitySpawnParams();
+		params.TransformMode = ETransformMode.WORLD;
+		for (int i = 0; i < 4; i++)
+			params.Transform[i] = job.m_Transform[i];
+
+		IEntity ent = GetGame().SpawnEntityPrefab(res, GetWorld(), params);
+		if (!ent) return false;
+
+		// Same registration as the vanilla link: an editable child of the composition,
+		// not a child in the transform hierarchy
+		SCR_EditableEntityComponent editableParent = SCR_EditableEntityComponent.Cast(job.m_Root.FindComponent(SCR_EditableEntityComponent));
+		SCR_EditableEntityComponent editableChild = SCR_EditableEntityComponent.Cast(ent.FindComponent(SCR_EditableEntityComponent));
+		if (editableParent && editableChild)
+			editableChild.SetParentEntity(editableParent);
+
+		return true;
+	}
+
+	protected static string GetPrefabName(IEntity ent)
+	{
+		EntityPrefabData prefabData = ent.GetPrefabData();
+		if (!prefabData) return ent.ClassName();
+		return prefabData.GetPrefabName();
+	}
+}
+
+// ---- Route linked composition entries through the budgeted spawner
+modded class SCR_EditorLinkComponent
+{
+	override void EOnInit(IEntity owner)
+	{
+		CAV_CompositionSpawnSystem spawner = CAV_CompositionSpawnSystem.GetInstance();
+		if (!spawner || !spawner.IsActive() || !Replication.IsServer() || IsSpawningIgnored() || !m_aEntries || m_aEntries.IsEmpty())
+		{
+			super.EOnInit(owner);
+			return;
+		}
+
+		array<ResourceName> prefabs = {};
+		array<vector> positions = {};
+		array<vector> angles = {};
+		foreach (SCR_EditorLinkEntry entry : m_aEntries)
+		{
+			prefabs.Insert(entry.m_Prefab);
+			positions.Insert(entry.m_vPosition);
+			angles.Insert(entry.m_vAngles);
+		}
+
+		// Vanilla init still runs for its editor bookkeeping, with the entries
+		// held back so it doesn't spawn them itself
+		array<ref SCR_EditorLinkEntry> entries = m_aEntries;
+		m_aEntries = {};
+		super.EOnInit(owner);
+		m_aEntries = entries;
+
+		// Not deleted from inside its own init
+		if (!spawner.Submit(owner, prefabs, positions, angles))
+			GetGame().GetCallqueue().CallLater(SCR_EntityHelper.DeleteEntityAndChildren, 0, false, owner);
+	}
+}
@@ -0,0 +1,58 @@
+// -----------------------------------------------------------------------------
+// CAV_EntityCatalogIndex.c
+// - The company catalogs share Configs/Factions/Common/Catalogs; this file only
+//   removes the per-query linear scans
+// - Vanilla SCR_EntityCatalog.GetEntryWithPrefab (arsenal, editor, spawners)
+//   goes through a per-catalog prefab map, so every existing caller benefits
+// - Misses are cached too, so a prefab that isn't listed costs one scan
+// - The map is rebuilt whenever the catalog's entry count changes, which covers
+//   a lookup made before the catalog was filled and entries merged in later
+// - Label and filter queries on SCR_EntityCatalog still scan
+// -----------------------------------------------------------------------------
+
+// ---- Prefab lookups on a single catalog
+modded class SCR_EntityCatalog
+{
+	// Null value = known miss
+	protected ref map<ResourceName, SCR_EntityCatalogEntry> m_CAV_ByPrefab;
+	protected int m_CAV_IndexedCount = -1;
+
+	override SCR_EntityCatalogEntry GetEntryWithPrefab(ResourceName prefabToFind)
+	{
+		int entryCount;
+		if (m_aEntityEntryList)
+			entryCount = m_aEntityEntryList.Count();
+
+		if (!m_CAV_ByPrefab || entryCount != m_CAV_IndexedCount)
+			CAV_BuildPrefabIndex();
+
+		SCR_EntityCatalogEntry entry;
+		if (m_CAV_ByPrefab.Find(prefabToFind, entry))
+			return entry;
+
+		CAV_Perf.Count("catalog.prefab_miss");
+		m_CAV_ByPrefab.Insert(prefabToFind, null);
+		return null;
+	}
+
+	protected void CAV_BuildPrefabIndex()
+	{
+		m_CAV_ByPrefab = new map<ResourceName, SCR_EntityCatalogEntry>();
+		m_CAV_IndexedCount = 0;
+		if (!m_aEntityEntryList)
+			return;
+
+		m_CAV_IndexedCount = m_aEntityEntryList.Count();
+		foreach (SCR_EntityCatalogEntry entry : m_aEntityEntryList)
+		{
+			if (!entry) continue;
+
+			// First entry listing a prefab wins, same as the vanilla scan
+			ResourceName prefab = entry.GetPrefab();
+			if (!prefab.IsEmpty() && !m_CAV_ByPrefab.Contains(prefab))
+				m_CAV_ByPrefab.Insert(prefab, entry);
+		}
+
+		CAV_Perf.Sample("catalog.index_prefabs", m_CAV_ByPrefab.Count());
+	}
+}
@@ -0,0 +1,433 @@
+// -----------------------------------------------------------------------------
+// CAV_FireMissionSystem.c
+// - Coordinates AI mortar groups driven by SCR_AIWaypointArtillerySupport
+// - Ballistic tables per mortar type, charge and high-angle elevation band are
+//   built once at init (range -> elevation, time of flight). Lookups are a
+//   binary search; nothing is solved per shot
+// - Tubes sharing a target are one fire mission. Between salvos a tube's
+//   artillery waypoint is taken off its group, so it holds fire without relying
+//   on what a shot count of 0 means. Every m_SalvoIntervalS the waypoint is put
+//   back with the salvo as its target shot count, staggered by time of flight
+//   so the salvo lands together; the waypoint completing ends the salvo
+// - Shells in flight are accounted from the table's flight times and capped
+//   server-wide (m_MaxShellsInFlight); over the cap, salvos wait their turn,
+//   so cost stays flat as more pits come online. A mission bigger than the
+//   cap fires a salvo clamped to it, spread evenly over its tubes; the tubes
+//   that take the odd extra shots rotate from salvo to salvo
+// - The vanilla AI still lays the tube; this only decides when and how much
+//   it fires
+// -----------------------------------------------------------------------------
+
+[BaseContainerProps()]
+class CAV_MortarBallistics
+{
+	[Attribute(defvalue: "", uiwidget: UIWidgets.EditBox, desc: "Applies to mortar groups whose prefab name contains this (empty = fallback)")]
+	string m_GroupPrefabFilter;
+
+	[Attribute(defvalue: "", uiwidget: UIWidgets.EditBox, desc: "Muzzle velocity per charge (m/s), lowest charge first")]
+	ref array<float> m_ChargeVelocities;
+
+	[Attribute(defvalue: "45", uiwidget: UIWidgets.EditBox, desc: "Lowest elevation of the band (deg)", params: "0 89 0.5")]
+	float m_MinElevationDeg;
+
+	[Attribute(defvalue: "85", uiwidget: UIWidgets.EditBox, desc: "Highest elevation of the band (deg)", params: "1 89.5 0.5")]
+	float m_MaxElevationDeg;
+
+	[Attribute(defvalue: "0.5", uiwidget: UIWidgets.EditBox, desc: "Table resolution (deg)", params: "0.1 5 0.1")]
+	float m_StepDeg;
+
+	// Per charge, ordered by descending elevation = ascending range
+	protected ref array<ref array<float>> m_Ranges = {};
+	protected ref array<ref array<float>> m_Elevations = {};
+	protected ref array<ref array<float>> m_Flights = {};
+
+	//------------------------------------------------------------------------------------------------
+	void Build()
+	{
+		m_Ranges.Clear();
+		m_Elevations.Clear();
+		m_Flights.Clear();
+
+		float g = 9.81;
+		foreach (float v : m_ChargeVelocities)
+		{
+			array<float> ranges = {};
+			array<float> elevations = {};
+			array<float> flights = {};
+
+			for (float deg = m_MaxElevationDeg; deg >= m_MinElevationDeg; deg -= m_StepDeg)
+			{
+				float rad = deg * Math.DEG2RAD;
+				ranges.Insert(v * v * Math.Sin(2 * rad) / g);
+				elevations.Insert(deg);
+				flights.Insert(2 * v * Math.Sin(rad) / g);
+			}
+
+			m_Ranges.Insert(ranges);
+			m_Elevations.Insert(elevations);
+			m_Flights.Insert(flights);
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------
+	// Lowest charge that reaches; false if the target is out of the band
+	bool Solve(float range, out int charge, out float elevationDeg, out float flightS)
+	{
+		for (charge = 0; charge < m_Ranges.Count(); charge++)
+		{
+			array<float> ranges = m_Ranges[charge];
+			if (ranges.IsEmpty() || range < ranges[0] || range > ranges[ranges.Count() - 1])
+				continue;
+
+			int lo = 0;
+			int hi = ranges.Count() - 1;
+			while (hi - lo > 1)
+			{
+				int mid = (lo + hi) / 2;
+				if (ranges[mid] < range)
+					lo = mid;
+				else
+					hi = mid;
+			}
+
+			float t = 0;
+			if (ranges[hi] > ranges[lo])
+				t = (range - ranges[lo]) / (ranges[hi] - ranges[lo]);
+
+			elevationDeg = Math.Lerp(m_Elevations[charge][lo], m_Elevations[charge][hi], t);
+			flightS = Math.Lerp(m_Flights[charge][lo], m_Flights[charge][hi], t);
+			return true;
+		}
+
+		charge = -1;
+		return false;
+	}
+}
+
+//------------------------------------------------------------------------------------------------
+class CAV_MortarTube
+{
+	SCR_AIGroup m_Group;
+	SCR_AIWaypointArtillerySupport m_Waypoint;
+	int m_BallisticsIndex;
+	float m_FlightS;           // to the mission target, from the table
+	float m_ReleaseAtS = -1;   // pending staggered release, -1 = none
+	int m_PendingShots;
+}
+
+class CAV_FireMission
+{
+	vector m_Target;
+	ref array<ref CAV_MortarTube> m_Tubes = {};
+	float m_NextSalvoS;
+	int m_FirstExtraTube;      // first tube to take an extra shot in a clamped salvo
+}
+
+class CAV_FireMissionSystem : GameSystem
+{
+	[Attribute(defvalue: "1", uiwidget: UIWidgets.CheckBox, desc: "Coordinate AI mortar fire as salvos")]
+	protected bool m_Active;
+
+	[Attribute(desc: "Ballistic tables per mortar type")]
+	protected ref array<ref CAV_MortarBallistics> m_Ballistics;
+
+	[Attribute(defvalue: "3", uiwidget: UIWidgets.EditBox, desc: "Shots per tube per salvo", params: "1 20 1")]
+	protected int m_ShotsPerSalvo;
+
+	[Attribute(defvalue: "45", uiwidget: UIWidgets.EditBox, desc: "Seconds between salvos of one mission", params: "5 600 1")]
+	protected float m_SalvoIntervalS;
+
+	[Attribute(defvalue: "3", uiwidget: UIWidgets.EditBox, desc: "Assumed seconds between shots of one tube", params: "0.5 30 0.5")]
+	protected float m_ShotIntervalS;
+
+	[Attribute(defvalue: "24", uiwidget: UIWidgets.EditBox, desc: "Server-wide cap on shells in flight", params: "1 500 1")]
+	protected int m_MaxShellsInFlight;
+
+	[Attribute(defvalue: "100", uiwidget: UIWidgets.EditBox, desc: "Artillery waypoints closer than this share one mission (m)", params: "0 1000 10")]
+	protected float m_MissionMergeRadius;
+
+	// --- State ---------------------------------------------------------------
+	protected ref array<ref CAV_FireMission> m_Missions = {};
+	protected ref set<SCR_AIGroup> m_Registered = new set<SCR_AIGroup>();
+
+	// Landing times of shells counted as in flight, unordered
+	protected ref array<float> m_InFlightUntilS = {};
+
+	//------------------------------------------------------------------------------------------------
+	override static void InitInfo(WorldSystemInfo outInfo)
+	{
+		outInfo
+			.SetAbstract(false)
+			.SetLocation(ESystemLocation.Server)
+			.AddPoint(ESystemPoint.Frame);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	static CAV_FireMissionSystem GetInstance()
+	{
+		World world = GetGame().GetWorld();
+		if (!world) return null;
+		return CAV_FireMissionSystem.Cast(world.FindSystem(CAV_FireMissionSystem));
+	}
+
+	//------------------------------------------------------------------------------------------------
+	override protected void OnInit()
+	{
+		if (m_Ballistics)
+		{
+			foreach (CAV_MortarBallistics ballistics : m_Ballistics)
+			{
+				ballistics.Build();
+			}
+		}
+
+		Enable(false);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	bool IsActive()
+	{
+		return m_Active && m_Ballistics && !m_Ballistics.IsEmpty();
+	}
+
+	// Table lookup for other callers (e.g. GM fire support); false if out of range
+	bool Solve(SCR_AIGroup group, float range, out int charge, out float elevationDeg, out float flightS)
+	{
+		int index = FindBallistics(group);
+		if (index == -1)
+			return false;
+		return m_Ballistics[index].Solve(range, charge, elevationDeg, flightS);
+	}
+
+	// --- Registration --------------------------------------------------------
+	// Call for any freshly spawned group; ignored unless it carries an artillery waypoint
+	static void RegisterIfArtillery(SCR_AIGroup group)
+	{
+		if (!group) return;
+
+		CAV_FireMissionSystem missions = GetInstance();
+		if (!missions || !missions.IsActive()) return;
+
+		array<AIWaypoint> waypoints = {};
+		group.GetWaypoints(waypoints);
+		foreach (AIWaypoint waypoint : waypoints)
+		{
+			SCR_AIWaypointArtillerySupport artillery = SCR_AIWaypointArtillerySupport.Cast(waypoint);
+			if (artillery)
+			{
+				missions.Register(group, artillery);
+				return;
+			}
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected void Register(SCR_AIGroup group, SCR_AIWaypointArtillerySupport waypoint)
+	{
+		if (m_Registered.Contains(group)) return;
+
+		CAV_MortarTube tube = new CAV_MortarTube();
+		tube.m_Group = group;
+		tube.m_Waypoint = waypoint;
+		tube.m_BallisticsIndex = FindBallistics(group);
+		if (tube.m_BallisticsIndex == -1) return;
+
+		vector target = waypoint.GetOrigin();
+		int charge;
+		float elevationDeg;
+		if (!m_Ballistics[tube.m_BallisticsIndex].Solve(vector.DistanceXZ(group.GetOrigin(), target), charge, elevationDeg, tube.m_FlightS))
+		{
+			CAV_Perf.Count("firemission.out_of_range");
+			return;
+		}
+
+		// Hold fire until the mission hands out a salvo
+		group.RemoveWaypoint(waypoint);
+
+		CAV_FireMission mission = FindMission(target);
+		if (!mission)
+		{
+			mission = new CAV_FireMission();
+			mission.m_Target = target;
+			mission.m_NextSalvoS = GetNowS();
+			m_Missions.Insert(mission);
+		}
+
+		mission.m_Tubes.Insert(tube);
+		m_Registered.Insert(group);
+		Enable(true);
+	}
+
+	// --- Frame update --------------------------------------------------------
+	override protected void OnUpdate(ESystemPoint point)
+	{
+		CAV_PerfScope perfScope = CAV_Perf.Scope("firemission.frame_ms");
+
+		float nowS = GetNowS();
+
+		for (int i = m_InFlightUntilS.Count() - 1; i >= 0; i--)
+		{
+			if (m_InFlightUntilS[i] <= nowS)
+				m_InFlightUntilS.Remove(i);
+		}
+
+		for (int m = m_Missions.Count() - 1; m >= 0; m--)
+		{
+			CAV_FireMission mission = m_Missions[m];
+			PruneTubes(mission);
+			if (mission.m_Tubes.IsEmpty())
+			{
+				m_Missions.Remove(m);
+				continue;
+			}
+
+			ReleaseStaggered(mission, nowS);
+
+			if (nowS >= mission.m_NextSalvoS)
+				TryScheduleSalvo(mission, nowS);
+		}
+
+		CAV_Perf.Sample("firemission.missions", m_Missions.Count());
+		CAV_Perf.Sample("firemission.in_flight", m_InFlightUntilS.Count());
+
+		if (m_Missions.IsEmpty())
+			Enable(false);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	// Whole salvo or nothing: partial salvos would defeat time-on-target. A salvo
+	// larger than the cap itself is clamped to the cap, or it could never fire
+	protected void TryScheduleSalvo(CAV_FireMission mission, float nowS)
+	{
+		int tubes = mission.m_Tubes.Count();
+		int shells = Math.Min(tubes * m_ShotsPerSalvo, m_MaxShellsInFlight);
+		if (m_InFlightUntilS.Count() + shells > m_MaxShellsInFlight)
+		{
+			CAV_Perf.Count("firemission.capped");
+			return;
+		}
+
+		if (shells < tubes * m_ShotsPerSalvo)
+			CAV_Perf.Count("firemission.clamped");
+
+		// Even split; (shells % tubes) tubes take one extra, starting where the last salvo stopped
+		int perTube = shells / tubes;
+		int extra = shells % tubes;
+		int first = mission.m_FirstExtraTube % tubes;
+
+		float longestFlightS = 0;
+		foreach (int t, CAV_MortarTube tube : mission.m_Tubes)
+		{
+			if (GetSalvoShots(t, tubes, first, perTube, extra) > 0)
+				longestFlightS = Math.Max(longestFlightS, tube.m_FlightS);
+		}
+
+		// Shorter flights release later so the first rounds land together
+		foreach (int t, CAV_MortarTube tube : mission.m_Tubes)
+		{
+			int shots = GetSalvoShots(t, tubes, first, perTube, extra);
+			if (shots <= 0) continue;
+
+			tube.m_ReleaseAtS = nowS + longestFlightS - tube.m_FlightS;
+			tube.m_PendingShots = shots;
+
+			float salvoDurationS = (shots - 1) * m_ShotIntervalS;
+			for (int s = 0; s < shots; s++)
+			{
+				m_InFlightUntilS.Insert(nowS + longestFlightS + salvoDurationS);
+			}
+		}
+
+		mission.m_FirstExtraTube = (first + extra) % tubes;
+		mission.m_NextSalvoS = nowS + m_SalvoIntervalS;
+		CAV_Perf.Count("firemission.salvos");
+	}
+
+	protected static int GetSalvoShots(int tube, int tubes, int first, int perTube, int extra)
+	{
+		if ((tube - first + tubes) % tubes < extra)
+			return perTube + 1;
+		return perTube;
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected void ReleaseStaggered(CAV_FireMission mission, float nowS)
+	{
+		foreach (CAV_MortarTube tube : mission.m_Tubes)
+		{
+			if (tube.m_ReleaseAtS < 0 || nowS < tube.m_ReleaseAtS) continue;
+
+			// Re-added fresh so the shot count starts over; an unfinished salvo is dropped
+			tube.m_Group.RemoveWaypoint(tube.m_Waypoint);
+			tube.m_Waypoint.SetTargetShotCount(tube.m_PendingShots);
+			tube.m_Group.AddWaypoint(tube.m_Waypoint);
+			tube.m_ReleaseAtS = -1;
+			tube.m_PendingShots = 0;
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected void PruneTubes(CAV_FireMission mission)
+	{
+		for (int i = mission.m_Tubes.Count() - 1; i >= 0; i--)
+		{
+			CAV_MortarTube tube = mission.m_Tubes[i];
+			if (tube.m_Group && tube.m_Waypoint && tube.m_Group.GetAgentsCount() > 0) continue;
+
+			m_Registered.RemoveItem(tube.m_Group);
+			mission.m_Tubes.Remove(i);
+		}
+	}
+
+	// --- Helpers -------------------------------------------------------------
+	protected CAV_FireMission FindMission(vector target)
+	{
+		float mergeSq = m_MissionMergeRadius * m_MissionMergeRadius;
+		foreach (CAV_FireMission mission : m_Missions)
+		{
+			if (vector.DistanceSqXZ(mission.m_Target, target) <= mergeSq)
+				return mission;
+		}
+		return null;
+	}
+
+	protected int FindBallistics(SCR_AIGroup group)
+	{
+		string prefab;
+		EntityPrefabData prefabData = group.GetPrefabData();
+		if (prefabData)
+			prefab = prefabData.GetPrefabName();
+
+		int fallback = -1;
+		foreach (int i, CAV_MortarBallistics ballistics : m_Ballistics)
+		{
+			if (ballistics.m_GroupPrefabFilter.IsEmpty())
+			{
+				if (fallback == -1)
+					fallback = i;
+				continue;
+			}
+
+			if (prefab.Contains(ballistics.m_GroupPrefabFilter))
+				return i;
+		}
+		return fallback;
+	}
+
+	protected float GetNowS()
+	{
+		return GetWorld().GetWorldTime() * 0.001;
+	}
+}
+
+// ---- Artillery patrols join a fire mission as soon as they spawn
+modded class SCR_AmbientPatrolSpawnPointComponent
+{
+	override void SpawnPatrol()
+	{
+		super.SpawnPatrol();
+
+		if (m_bIsArtilleryGroup)
+			CAV_FireMissionSystem.RegisterIfArtillery(m_Group);
+	}
+}
@@ -0,0 +1,384 @@
+// -----------------------------------------------------------------------------
+// CAV_GarbagePolicySystem.c
+// - Cleans up what SCR_GarbageSystem's Vehicle rule doesn't: corpses, dropped
+//   gear and dropped supply containers
+// - Per-category base lifetimes shrink as the tracked count passes its soft cap
+//   or as server FPS falls below the target (never below the category minimum)
+// - Player-distance checks use a CAV_SpatialGrid of player positions rebuilt
+//   once per evaluation, not a player scan per entity
+// - Expiry is checked round-robin under a per-frame budget
+// - Items leaving a storage are only tracked if they are still loose in the
+//   world a frame later, so moves, arsenal use and re-kits don't count
+// -----------------------------------------------------------------------------
+
+enum CAV_EGarbageKind
+{
+	CORPSE,
+	DROPPED_ITEM,
+	SUPPLY_CONTAINER
+}
+
+[BaseContainerProps(), SCR_BaseContainerCustomTitleEnum(CAV_EGarbageKind, "m_Kind")]
+class CAV_GarbageCategory
+{
+	[Attribute(defvalue: "0", uiwidget: UIWidgets.ComboBox, desc: "What this category collects", enums: ParamEnumArray.FromEnum(CAV_EGarbageKind))]
+	CAV_EGarbageKind m_Kind;
+
+	[Attribute(defvalue: "600", uiwidget: UIWidgets.EditBox, desc: "Lifetime with no pressure (s)", params: "10 7200 10")]
+	float m_LifetimeS;
+
+	[Attribute(defvalue: "60", uiwidget: UIWidgets.EditBox, desc: "Lifetime floor under full pressure (s)", params: "5 7200 5")]
+	float m_MinLifetimeS;
+
+	[Attribute(defvalue: "100", uiwidget: UIWidgets.EditBox, desc: "Never delete while a player is within this range (m)", params: "0 1000 5")]
+	float m_PlayerDistance;
+
+	[Attribute(defvalue: "200", uiwidget: UIWidgets.EditBox, desc: "Tracked count above which lifetimes start shrinking", params: "1 10000 1")]
+	int m_SoftCap;
+}
+
+class CAV_GarbagePolicySystem : GameSystem
+{
+	[Attribute(desc: "Garbage categories; one entry per kind")]
+	protected ref array<ref CAV_GarbageCategory> m_Categories;
+
+	[Attribute(defvalue: "30", uiwidget: UIWidgets.EditBox, desc: "Below this server FPS lifetimes shrink proportionally", params: "5 120 1")]
+	protected float m_TargetFps;
+
+	[Attribute(defvalue: "5", uiwidget: UIWidgets.EditBox, desc: "Seconds between pressure/player-grid updates", params: "1 60 1")]
+	protected float m_EvaluateIntervalS;
+
+	[Attribute(defvalue: "64", uiwidget: UIWidgets.EditBox, desc: "Max tracked entities checked per frame", params: "1 1024 1")]
+	protected int m_MaxChecksPerFrame;
+
+	[Attribute(defvalue: "4", uiwidget: UIWidgets.EditBox, desc: "Max deletions per frame", params: "1 64 1")]
+	protected int m_MaxDeletesPerFrame;
+
+	[Attribute(defvalue: "100", uiwidget: UIWidgets.EditBox, desc: "Player grid cell size (m)", params: "25 1000 5")]
+	protected float m_PlayerCellSize;
+
+	// --- State ---------------------------------------------------------------
+	// Parallel arrays, swap-removed; m_Cursor walks them round-robin
+	protected ref array<IEntity> m_Entities = {};
+	protected ref array<int> m_CategoryIdx = {};
+	protected ref array<float> m_InsertedAtS = {};
+	protected ref map<IEntity, int> m_IndexByEntity = new map<IEntity, int>();
+	protected int m_Cursor;
+
+	// Items that left a storage this frame; checked for the ground next frame
+	protected ref set<IEntity> m_PendingItems = new set<IEntity>();
+
+	protected ref array<CAV_GarbageCategory> m_CategoryByKind = {};
+	protected ref array<int> m_CountByCategory = {};
+	protected ref array<float> m_ScaleByCategory = {};
+
+	protected ref CAV_SpatialGrid m_PlayerGrid;
+	protected ref array<vector> m_PlayerPositions = {};
+	protected ref array<int> m_Candidates = {};
+
+	protected float m_FpsAvg;
+	protected float m_NextEvalS;
+
+	//------------------------------------------------------------------------------------------------
+	override static void InitInfo(WorldSystemInfo outInfo)
+	{
+		outInfo
+			.SetAbstract(false)
+			.SetLocation(ESystemLocation.Server)
+			.AddPoint(ESystemPoint.Frame);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	static CAV_GarbagePolicySystem GetInstance()
+	{
+		World world = GetGame().GetWorld();
+		if (!world) return null;
+		return CAV_GarbagePolicySystem.Cast(world.FindSystem(CAV_GarbagePolicySystem));
+	}
+
+	//------------------------------------------------------------------------------------------------
+	override protected void OnInit()
+	{
+		m_PlayerGrid = new CAV_SpatialGrid(m_PlayerCellSize);
+		m_FpsAvg = m_TargetFps;
+
+		// Kind -> category lookup; the first entry of a kind wins
+		array<int> kindValues = {};
+		int kinds = SCR_Enum.GetEnumValues(CAV_EGarbageKind, kindValues);
+		m_CategoryByKind.Resize(kinds);
+		if (m_Categories)
+		{
+			foreach (CAV_GarbageCategory category : m_Categories)
+			{
+				if (category.m_Kind >= 0 && category.m_Kind < kinds && !m_CategoryByKind[category.m_Kind])
+					m_CategoryByKind[category.m_Kind] = category;
+			}
+		}
+
+		m_CountByCategory.Resize(kinds);
+		m_ScaleByCategory.Resize(kinds);
+		for (int i = 0; i < kinds; i++)
+		{
+			m_CountByCategory[i] = 0;
+			m_ScaleByCategory[i] = 1;
+		}
+
+		Enable(false);
+	}
+
+	// --- Intake --------------------------------------------------------------
+	void InsertCorpse(IEntity entity)
+	{
+		Track(entity, CAV_EGarbageKind.CORPSE);
+	}
+
+	// A storage move is a remove followed by an insert in the same frame, so
+	// whether the item really ended up on the ground is decided next frame
+	void InsertDroppedItem(IEntity item)
+	{
+		m_PendingItems.Insert(item);
+		Enable(true);
+	}
+
+	protected void TrackPendingItems()
+	{
+		foreach (IEntity item : m_PendingItems)
+		{
+			if (!item || !IsLoose(item)) continue;
+
+			if (item.FindComponent(SCR_ResourceComponent))
+				Track(item, CAV_EGarbageKind.SUPPLY_CONTAINER);
+			else
+				Track(item, CAV_EGarbageKind.DROPPED_ITEM);
+		}
+		m_PendingItems.Clear();
+	}
+
+	protected void Track(IEntity entity, CAV_EGarbageKind kind)
+	{
+		if (!entity || !m_CategoryByKind[kind]) return;
+
+		// Re-dropped: restart its clock
+		int idx;
+		if (m_IndexByEntity.Find(entity, idx))
+		{
+			m_InsertedAtS[idx] = GetNowS();
+			return;
+		}
+
+		idx = m_Entities.Insert(entity);
+		m_IndexByEntity.Insert(entity, idx);
+		m_CategoryIdx.Insert(kind);
+		m_InsertedAtS.Insert(GetNowS());
+		m_CountByCategory[kind] = m_CountByCategory[kind] + 1;
+
+		Enable(true);
+	}
+
+	protected void RemoveAt(int idx)
+	{
+		int kind = m_CategoryIdx[idx];
+		m_CountByCategory[kind] = m_CountByCategory[kind] - 1;
+
+		IEntity entity = m_Entities[idx];
+		if (entity)
+			m_IndexByEntity.Remove(entity);
+		else
+			PruneIndex();
+
+		int last = m_Entities.Count() - 1;
+		if (idx != last && m_Entities[last])
+			m_IndexByEntity.Set(m_Entities[last], idx);
+
+		m_Entities[idx] = m_Entities[last];
+		m_CategoryIdx[idx] = m_CategoryIdx[last];
+		m_InsertedAtS[idx] = m_InsertedAtS[last];
+		m_Entities.Remove(last);
+		m_CategoryIdx.Remove(last);
+		m_InsertedAtS.Remove(last);
+	}
+
+	// Entities deleted elsewhere leave a null key behind that can't be looked up
+	protected void PruneIndex()
+	{
+		for (int i = m_IndexByEntity.Count() - 1; i >= 0; i--)
+		{
+			if (!m_IndexByEntity.GetKey(i))
+				m_IndexByEntity.RemoveElement(i);
+		}
+	}
+
+	// Effective lifetime for a category at the current pressure
+	float GetLifetime(CAV_EGarbageKind kind)
+	{
+		CAV_GarbageCategory category = m_CategoryByKind[kind];
+		if (!category) return 0;
+		return Math.Max(category.m_LifetimeS * m_ScaleByCategory[kind], category.m_MinLifetimeS);
+	}
+
+	// --- Frame update --------------------------------------------------------
+	override protected void OnUpdate(ESystemPoint point)
+	{
+		CAV_PerfScope perfScope = CAV_Perf.Scope("garbage.frame_ms");
+
+		float timeSlice = GetWorld().GetTimeSlice();
+		if (timeSlice > 0)
+			m_FpsAvg += (1 / timeSlice - m_FpsAvg) * 0.05;
+
+		if (!m_PendingItems.IsEmpty())
+			TrackPendingItems();
+
+		float nowS = GetNowS();
+		if (nowS >= m_NextEvalS)
+		{
+			m_NextEvalS = nowS + m_EvaluateIntervalS;
+			Evaluate();
+		}
+
+		CheckExpired(nowS);
+
+		if (m_Entities.IsEmpty() && m_PendingItems.IsEmpty())
+			Enable(false);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected void Evaluate()
+	{
+		m_PlayerGrid.Clear();
+		CAV_SpatialGrid.GatherPlayerPositions(m_PlayerPositions);
+		foreach (int i, vector pos : m_PlayerPositions)
+		{
+			m_PlayerGrid.Insert(i, pos);
+		}
+
+		// FPS pressure is shared, count pressure is per category
+		float fpsScale = Math.Clamp(m_FpsAvg / m_TargetFps, 0, 1);
+		foreach (int kind, CAV_GarbageCategory category : m_CategoryByKind)
+		{
+			if (!category) continue;
+
+			float countScale = 1;
+			int count = m_CountByCategory[kind];
+			if (count > category.m_SoftCap)
+			{
+				float softCap = category.m_SoftCap;
+				countScale = softCap / count;
+			}
+
+			m_ScaleByCategory[kind] = Math.Min(fpsScale, countScale);
+		}
+
+		CAV_Perf.Sample("garbage.tracked", m_Entities.Count());
+		CAV_Perf.Sample("garbage.fps", m_FpsAvg);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected void CheckExpired(float nowS)
+	{
+		int checks = Math.Min(m_MaxChecksPerFrame, m_Entities.Count());
+		int deleted = 0;
+
+		while (checks > 0 && deleted < m_MaxDeletesPerFrame && !m_Entities.IsEmpty())
+		{
+			checks--;
+			if (m_Cursor >= m_Entities.Count())
+				m_Cursor = 0;
+
+			int idx = m_Cursor;
+			IEntity entity = m_Entities[idx];
+			CAV_EGarbageKind kind = m_CategoryIdx[idx];
+
+			// Already gone, or no longer garbage (revived, picked up, stored)
+			if (!entity || !IsStillGarbage(entity, kind))
+			{
+				RemoveAt(idx);
+				continue;
+			}
+
+			m_Cursor++;
+			if (nowS - m_InsertedAtS[idx] < GetLifetime(kind)) continue;
+			if (IsPlayerNear(entity.GetOrigin(), m_CategoryByKind[kind].m_PlayerDistance)) continue;
+
+			RemoveAt(idx);
+			m_Cursor = idx;
+			SCR_EntityHelper.DeleteEntityAndChildren(entity);
+			deleted++;
+		}
+
+		CAV_Perf.Count("garbage.deleted", deleted);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected bool IsStillGarbage(IEntity entity, CAV_EGarbageKind kind)
+	{
+		if (kind == CAV_EGarbageKind.CORPSE)
+		{
+			ChimeraCharacter character = ChimeraCharacter.Cast(entity);
+			if (!character) return true;
+			CharacterControllerComponent ctrl = character.GetCharacterController();
+			return !ctrl || ctrl.IsDead();
+		}
+
+		return IsLoose(entity);
+	}
+
+	// Item lying in the world, not in a storage or attached to anything
+	protected bool IsLoose(IEntity entity)
+	{
+		if (entity.GetParent()) return false;
+		InventoryItemComponent itemComp = InventoryItemComponent.Cast(entity.FindComponent(InventoryItemComponent));
+		return !itemComp || !itemComp.GetParentSlot();
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected bool IsPlayerNear(vector pos, float distance)
+	{
+		if (distance <= 0 || m_PlayerPositions.IsEmpty()) return false;
+
+		m_Candidates.Clear();
+		m_PlayerGrid.QueryRadius(pos, distance, m_Candidates);
+
+		float distanceSq = distance * distance;
+		foreach (int i : m_Candidates)
+		{
+			if (vector.DistanceSqXZ(pos, m_PlayerPositions[i]) <= distanceSq)
+				return true;
+		}
+		return false;
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected float GetNowS()
+	{
+		return GetWorld().GetWorldTime() * 0.001;
+	}
+}
+
+// ---- Intake hooks
+modded class SCR_CharacterDamageManagerComponent
+{
+	override void OnDamageStateChanged(EDamageState state)
+	{
+		super.OnDamageStateChanged(state);
+
+		if (state != EDamageState.DESTROYED || !Replication.IsServer()) return;
+
+		CAV_GarbagePolicySystem garbage = CAV_GarbagePolicySystem.GetInstance();
+		if (garbage)
+			garbage.InsertCorpse(GetOwner());
+	}
+}
+
+modded class SCR_InventoryStorageManagerComponent
+{
+	override protected void OnItemRemoved(BaseInventoryStorageComponent storageOwner, IEntity item)
+	{
+		super.OnItemRemoved(storageOwner, item);
+
+		if (!item || !Replication.IsServer()) return;
+
+		CAV_GarbagePolicySystem garbage = CAV_GarbagePolicySystem.GetInstance();
+		if (garbage)
+			garbage.InsertDroppedItem(item);
+	}
+}
@@ -0,0 +1,372 @@
+// -----------------------------------------------------------------------------
+// CAV_PatrolSchedulerSystem.c
+// - Takes ambient patrol spawn points away from SCR_AmbientPatrolSystem's
+//   linear scan and buckets them in a CAV_SpatialGrid
+// - Every m_EvaluateIntervalS: points near players are queued for spawn, live
+//   points beyond the (larger) despawn radius for m_DespawnDelayS are queued
+//   for despawn
+// - Queues drain under a per-frame budget and a global live-AI cap
+// - With CAV_AIVirtualizationSystem active, spawned groups are handed to it and
+//   virtualized (state kept) instead of despawned
+// - Respawn follows each point's own m_iRespawnPeriod / m_iRespawnWaves, as
+//   SCR_AmbientPatrolSystem does
+// - Off by default (m_Active); the Legacy PvE missions, whose worlds are built
+//   on ambient patrols, turn it on in their ChimeraSystemsConfig.conf
+// -----------------------------------------------------------------------------
+
+// Spawn point lifecycle inside the scheduler
+enum CAV_EPatrolPointState
+{
+	IDLE,        // nothing spawned, eligible
+	QUEUED,      // waiting in the spawn queue
+	ACTIVE,      // group spawned
+	ELIMINATED,  // group killed; waits for the point's respawn period, if it has waves left
+	HANDED_OFF   // group owned by CAV_AIVirtualizationSystem until it is eliminated
+}
+
+class CAV_PatrolSchedulerSystem : GameSystem
+{
+	[Attribute(defvalue: "0", uiwidget: UIWidgets.CheckBox, desc: "Schedule ambient patrols here instead of SCR_AmbientPatrolSystem")]
+	protected bool m_Active;
+
+	[Attribute(defvalue: "500", uiwidget: UIWidgets.EditBox, desc: "Grid cell size (m)", params: "50 5000 10")]
+	protected float m_CellSize;
+
+	[Attribute(defvalue: "800", uiwidget: UIWidgets.EditBox, desc: "Spawn a patrol when a player is within this range (m)", params: "50 5000 10")]
+	protected float m_SpawnRadius;
+
+	[Attribute(defvalue: "1100", uiwidget: UIWidgets.EditBox, desc: "Despawn only when every player is beyond this range (m); keep > spawn radius", params: "50 6000 10")]
+	protected float m_DespawnRadius;
+
+	[Attribute(defvalue: "30", uiwidget: UIWidgets.EditBox, desc: "Seconds a patrol must stay unobserved before it is despawned", params: "0 600 1")]
+	protected float m_DespawnDelayS;
+
+	[Attribute(defvalue: "2", uiwidget: UIWidgets.EditBox, desc: "Seconds between proximity evaluations", params: "0.25 30 0.25")]
+	protected float m_EvaluateIntervalS;
+
+	[Attribute(defvalue: "1", uiwidget: UIWidgets.EditBox, desc: "Max patrol spawns per frame", params: "1 16 1")]
+	protected int m_MaxSpawnsPerFrame;
+
+	[Attribute(defvalue: "2", uiwidget: UIWidgets.EditBox, desc: "Max patrol despawns per frame", params: "1 32 1")]
+	protected int m_MaxDespawnsPerFrame;
+
+	[Attribute(defvalue: "160", uiwidget: UIWidgets.EditBox, desc: "No new patrols while this many AI are alive", params: "0 1000 1")]
+	protected int m_MaxLiveAI;
+
+	// --- State ---------------------------------------------------------------
+	// Parallel arrays indexed by point id (never reused; unregistered = null point)
+	protected ref array<SCR_AmbientPatrolSpawnPointComponent> m_Points = {};
+	protected ref array<vector> m_Positions = {};
+	protected ref array<CAV_EPatrolPointState> m_States = {};
+	protected ref array<float> m_FarSinceS = {};       // -1 while observed
+	protected ref array<float> m_EliminatedAtS = {};
+	protected ref array<int> m_WavesLeft = {};         // respawns still allowed; -1 = unlimited
+	protected ref array<int> m_SeenStamp = {};         // dedup within one evaluation
+	protected ref map<SCR_AmbientPatrolSpawnPointComponent, int> m_IdByPoint = new map<SCR_AmbientPatrolSpawnPointComponent, int>();
+
+	protected ref CAV_SpatialGrid m_Grid;
+	protected ref array<int> m_ActiveIds = {};
+	protected ref array<int> m_SpawnQueue = {};
+	protected ref array<int> m_DespawnQueue = {};
+
+	protected ref array<vector> m_PlayerPositions = {};
+	protected ref array<int> m_Candidates = {};
+	protected int m_EvalStamp;
+	protected float m_NextEvalS;
+
+	//------------------------------------------------------------------------------------------------
+	override static void InitInfo(WorldSystemInfo outInfo)
+	{
+		outInfo
+			.SetAbstract(false)
+			.SetLocation(ESystemLocation.Server)
+			.AddPoint(ESystemPoint.Frame);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	static CAV_PatrolSchedulerSystem GetInstance()
+	{
+		World world = GetGame().GetWorld();
+		if (!world) return null;
+		return CAV_PatrolSchedulerSystem.Cast(world.FindSystem(CAV_PatrolSchedulerSystem));
+	}
+
+	//------------------------------------------------------------------------------------------------
+	override protected void OnInit()
+	{
+		m_Grid = new CAV_SpatialGrid(m_CellSize);
+		if (m_DespawnRadius < m_SpawnRadius)
+			m_DespawnRadius = m_SpawnRadius;
+
+		Enable(false);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	bool IsActive()
+	{
+		return m_Active;
+	}
+
+	// --- Registration (from modded SCR_AmbientPatrolSystem) ------------------
+	void Register(notnull SCR_AmbientPatrolSpawnPointComponent point)
+	{
+		if (m_IdByPoint.Contains(point)) return;
+
+		vector pos = point.GetOwner().GetOrigin();
+		int id = m_Points.Insert(point);
+		m_Positions.Insert(pos);
+		m_States.Insert(CAV_EPatrolPointState.IDLE);
+		m_FarSinceS.Insert(-1);
+		m_EliminatedAtS.Insert(0);
+		m_WavesLeft.Insert(point.CAV_GetRespawnWaves());
+		m_SeenStamp.Insert(0);
+		m_IdByPoint.Insert(point, id);
+		m_Grid.Insert(id, pos);
+
+		Enable(true);
+	}
+
+	void Unregister(notnull SCR_AmbientPatrolSpawnPointComponent point)
+	{
+		int id;
+		if (!m_IdByPoint.Find(point, id)) return;
+
+		m_Grid.Remove(id, m_Positions[id]);
+		m_ActiveIds.RemoveItem(id);
+		m_IdByPoint.Remove(point);
+		m_Points[id] = null;
+	}
+
+	// Called by CAV_AIVirtualizationSystem when a handed-off group is wiped out
+	void OnHandedOffEliminated(int id, float nowS)
+	{
+		if (id < 0 || id >= m_States.Count() || m_States[id] != CAV_EPatrolPointState.HANDED_OFF) return;
+
+		// The point still thinks its (deleted or re-created) group is out; reset it
+		SCR_AmbientPatrolSpawnPointComponent sp = m_Points[id];
+		if (sp && sp.GetIsSpawned())
+			sp.DespawnPatrol();
+
+		m_States[id] = CAV_EPatrolPointState.ELIMINATED;
+		m_EliminatedAtS[id] = nowS;
+		CAV_Perf.Count("patrol.eliminated");
+	}
+
+	// --- Frame update --------------------------------------------------------
+	override protected void OnUpdate(ESystemPoint point)
+	{
+		CAV_PerfScope perfScope = CAV_Perf.Scope("patrol.frame_ms");
+
+		float nowS = GetWorld().GetWorldTime() * 0.001;
+		if (nowS >= m_NextEvalS)
+		{
+			m_NextEvalS = nowS + m_EvaluateIntervalS;
+			Evaluate(nowS);
+		}
+
+		DrainDespawns();
+		DrainSpawns();
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected void Evaluate(float nowS)
+	{
+		CAV_SpatialGrid.GatherPlayerPositions(m_PlayerPositions);
+		m_EvalStamp++;
+
+		float spawnSq = m_SpawnRadius * m_SpawnRadius;
+		float despawnSq = m_DespawnRadius * m_DespawnRadius;
+
+		// Live points: notice kills, apply hysteresis
+		for (int i = m_ActiveIds.Count() - 1; i >= 0; i--)
+		{
+			int id = m_ActiveIds[i];
+			SCR_AmbientPatrolSpawnPointComponent sp = m_Points[id];
+			if (!sp)
+			{
+				m_ActiveIds.Remove(i);
+				continue;
+			}
+
+			// Spawned group is gone and we didn't despawn it: it was killed
+			if (!sp.GetIsSpawned())
+			{
+				m_States[id] = CAV_EPatrolPointState.ELIMINATED;
+				m_EliminatedAtS[id] = nowS;
+				m_ActiveIds.Remove(i);
+				CAV_Perf.Count("patrol.eliminated");
+				continue;
+			}
+
+			if (CAV_SpatialGrid.MinDistanceSq2D(m_Positions[id], m_PlayerPositions) <= despawnSq)
+			{
+				m_FarSinceS[id] = -1;
+				continue;
+			}
+
+			if (m_FarSinceS[id] < 0)
+				m_FarSinceS[id] = nowS;
+			else if (nowS - m_FarSinceS[id] >= m_DespawnDelayS && m_DespawnQueue.Find(id) == -1)
+				m_DespawnQueue.Insert(id);
+		}
+
+		// Idle points: only those in cells around players are looked at
+		foreach (vector playerPos : m_PlayerPositions)
+		{
+			m_Candidates.Clear();
+			m_Grid.QueryRadius(playerPos, m_SpawnRadius, m_Candidates);
+
+			foreach (int id : m_Candidates)
+			{
+				if (m_SeenStamp[id] == m_EvalStamp) continue;
+				m_SeenStamp[id] = m_EvalStamp;
+
+				if (!m_Points[id]) continue;
+
+				CAV_EPatrolPointState state = m_States[id];
+				if (state == CAV_EPatrolPointState.ELIMINATED)
+				{
+					if (!CanRespawn(id, nowS)) continue;
+					if (m_WavesLeft[id] > 0)
+						m_WavesLeft[id] = m_WavesLeft[id] - 1;
+					m_States[id] = CAV_EPatrolPointState.IDLE;
+					state = CAV_EPatrolPointState.IDLE;
+				}
+
+				if (state != CAV_EPatrolPointState.IDLE) continue;
+				if (vector.DistanceSqXZ(m_Positions[id], playerPos) > spawnSq) continue;
+
+				m_States[id] = CAV_EPatrolPointState.QUEUED;
+				m_SpawnQueue.Insert(id);
+			}
+		}
+
+		CAV_Perf.Sample("patrol.active", m_ActiveIds.Count());
+		CAV_Perf.Sample("patrol.spawn_backlog", m_SpawnQueue.Count());
+	}
+
+	//------------------------------------------------------------------------------------------------
+	// Same rule as SCR_AmbientPatrolSystem: no period means no respawn, otherwise
+	// wait out the period while waves remain
+	protected bool CanRespawn(int id, float nowS)
+	{
+		int periodS = m_Points[id].CAV_GetRespawnPeriod();
+		if (periodS <= 0 || m_WavesLeft[id] == 0)
+			return false;
+
+		return nowS - m_EliminatedAtS[id] >= periodS;
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected void DrainSpawns()
+	{
+		if (m_SpawnQueue.IsEmpty()) return;
+
+		AIWorld aiWorld = GetGame().GetAIWorld();
+		CAV_AIVirtualizationSystem virtualization = CAV_AIVirtualizationSystem.GetInstance();
+		int spawned = 0;
+		while (!m_SpawnQueue.IsEmpty() && spawned < m_MaxSpawnsPerFrame)
+		{
+			// Over the cap: leave the queue intact and try again next frame
+			if (aiWorld && m_MaxLiveAI > 0 && aiWorld.GetCurrentAmountOfLimitedAIs() >= m_MaxLiveAI)
+			{
+				CAV_Perf.Count("patrol.capped_frames");
+				return;
+			}
+
+			int id = m_SpawnQueue[0];
+			m_SpawnQueue.RemoveOrdered(0);
+
+			SCR_AmbientPatrolSpawnPointComponent sp = m_Points[id];
+			if (!sp || m_States[id] != CAV_EPatrolPointState.QUEUED) continue;
+
+			if (sp.GetIsPaused() || sp.GetIsSpawned())
+			{
+				m_States[id] = CAV_EPatrolPointState.IDLE;
+				continue;
+			}
+
+			sp.SpawnPatrol();
+			spawned++;
+
+			if (virtualization && virtualization.IsActive() && sp.CAV_GetSpawnedGroup())
+			{
+				virtualization.Adopt(sp.CAV_GetSpawnedGroup(), sp, id);
+				m_States[id] = CAV_EPatrolPointState.HANDED_OFF;
+				continue;
+			}
+
+			m_States[id] = CAV_EPatrolPointState.ACTIVE;
+			m_FarSinceS[id] = -1;
+			m_ActiveIds.Insert(id);
+		}
+
+		CAV_Perf.Count("patrol.spawned", spawned);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected void DrainDespawns()
+	{
+		int despawned = 0;
+		while (!m_DespawnQueue.IsEmpty() && despawned < m_MaxDespawnsPerFrame)
+		{
+			int id = m_DespawnQueue[0];
+			m_DespawnQueue.RemoveOrdered(0);
+
+			SCR_AmbientPatrolSpawnPointComponent sp = m_Points[id];
+			if (!sp || m_States[id] != CAV_EPatrolPointState.ACTIVE) continue;
+
+			// A player came back while it was queued
+			if (m_FarSinceS[id] < 0) continue;
+
+			sp.DespawnPatrol();
+			m_States[id] = CAV_EPatrolPointState.IDLE;
+			m_ActiveIds.RemoveItem(id);
+			despawned++;
+		}
+
+		CAV_Perf.Count("patrol.despawned", despawned);
+	}
+}
+
+// ---- Route registrations to the 7Cav scheduler when it is active
+modded class SCR_AmbientPatrolSystem
+{
+	override void RegisterPatrol(notnull SCR_AmbientPatrolSpawnPointComponent patrol)
+	{
+		CAV_PatrolSchedulerSystem scheduler = CAV_PatrolSchedulerSystem.GetInstance();
+		if (scheduler && scheduler.IsActive())
+		{
+			scheduler.Register(patrol);
+			return;
+		}
+
+		super.RegisterPatrol(patrol);
+	}
+
+	override void UnregisterPatrol(notnull SCR_AmbientPatrolSpawnPointComponent patrol)
+	{
+		CAV_PatrolSchedulerSystem scheduler = CAV_PatrolSchedulerSystem.GetInstance();
+		if (scheduler && scheduler.IsActive())
+		{
+			scheduler.Unregister(patrol);
+			return;
+		}
+
+		super.UnregisterPatrol(patrol);
+	}
+}
+
+// ---- Per-point respawn settings the scheduler honours
+modded class SCR_AmbientPatrolSpawnPointComponent
+{
+	int CAV_GetRespawnPeriod()
+	{
+		return m_iRespawnPeriod;
+	}
+
+	int CAV_GetRespawnWaves()
+	{
+		return m_iRespawnWaves;
+	}
+}
@@ -0,0 +1,174 @@
+// -----------------------------------------------------------------------------
+// CAV_Perf.c
+// - Counters, scoped timers and min/avg/max stats for 7Cav scripts
+// - Every entry point checks CAV_Perf.s_Enabled first; disabled = one bool test
+// - CAV_PerfSystem turns it on (config or -cavPerf) and dumps JSON lines to $profile:
+//
+// Usage:
+//   CAV_PerfScope scope = CAV_Perf.Scope("radio.frame_ms");  // timed until it goes out of scope
+//   CAV_Perf.Count("role.assign.accepted");
+//   CAV_Perf.Sample("radio.queue_len", queued);
+// -----------------------------------------------------------------------------
+
+// ---- One named stat
+class CAV_PerfStat
+{
+	int   m_Count;
+	float m_Sum;
+	float m_Min;
+	float m_Max;
+
+	void Add(float value, int count = 1)
+	{
+		if (m_Count == 0 || value < m_Min) m_Min = value;
+		if (m_Count == 0 || value > m_Max) m_Max = value;
+		m_Count += count;
+		m_Sum += value;
+	}
+
+	string ToJson(string name)
+	{
+		float avg = 0;
+		if (m_Count > 0) avg = m_Sum / m_Count;
+		return string.Format("\"%1\":{\"n\":%2,\"sum\":%3,\"min\":%4,\"avg\":%5,\"max\":%6}", name, m_Count, m_Sum, m_Min, avg, m_Max);
+	}
+}
+
+// ---- Scoped timer; records elapsed ms into its stat when released
+class CAV_PerfScope
+{
+	protected string m_Name;
+	protected int m_StartMs;
+
+	void CAV_PerfScope(string name)
+	{
+		m_Name = name;
+		m_StartMs = System.GetTickCount();
+	}
+
+	void ~CAV_PerfScope()
+	{
+		CAV_Perf.Sample(m_Name, System.GetTickCount() - m_StartMs);
+	}
+}
+
+// ---- Static front end
+class CAV_Perf
+{
+	static bool s_Enabled;
+
+	protected static ref map<string, ref CAV_PerfStat> s_Stats = new map<string, ref CAV_PerfStat>();
+
+	// Null when disabled, so the caller's local costs nothing
+	static CAV_PerfScope Scope(string name)
+	{
+		if (!s_Enabled) return null;
+		return new CAV_PerfScope(name);
+	}
+
+	// Counter: n events (n is also summed, so batch counts keep their total)
+	static void Count(string name, int n = 1)
+	{
+		if (!s_Enabled || n == 0) return;
+		GetStat(name).Add(n, 1);
+	}
+
+	// Histogram-style sample (min/avg/max over the dump window)
+	static void Sample(string name, float value)
+	{
+		if (!s_Enabled) return;
+		GetStat(name).Add(value);
+	}
+
+	protected static CAV_PerfStat GetStat(string name)
+	{
+		CAV_PerfStat stat = s_Stats.Get(name);
+		if (!stat)
+		{
+			stat = new CAV_PerfStat();
+			s_Stats.Insert(name, stat);
+		}
+		return stat;
+	}
+
+	// Append one JSON line with every stat collected since the last dump, then reset
+	static void Dump(string path, float worldTimeS)
+	{
+		if (s_Stats.IsEmpty()) return;
+
+		string line = string.Format("{\"t\":%1,\"server\":%2,\"stats\":{", worldTimeS, Replication.IsServer());
+		bool first = true;
+		foreach (string name, CAV_PerfStat stat : s_Stats)
+		{
+			if (!first) line += ",";
+			line += stat.ToJson(name);
+			first = false;
+		}
+		line += "}}";
+
+		FileHandle fh = FileIO.OpenFile(path, FileMode.APPEND);
+		if (fh)
+		{
+			fh.WriteLine(line);
+			fh.Close();
+		}
+		else
+			PrintFormat("[CAV_Perf] Could not open %1 for writing", path, level: LogLevel.WARNING);
+
+		s_Stats.Clear();
+	}
+}
+
+// ---- Owner of the enabled flag and the periodic dump
+class CAV_PerfSystem : GameSystem
+{
+	[Attribute(defvalue: "0", uiwidget: UIWidgets.CheckBox, desc: "Collect 7Cav script stats (also enabled by the -cavPerf launch parameter)")]
+	protected bool m_Enabled;
+
+	[Attribute(defvalue: "60", uiwidget: UIWidgets.EditBox, desc: "Seconds between dumps", params: "1 3600 1")]
+	protected float m_DumpIntervalS;
+
+	[Attribute(defvalue: "$profile:7cav_perf.jsonl", uiwidget: UIWidgets.EditBox, desc: "JSON lines output file")]
+	protected string m_OutputPath;
+
+	protected float m_NextDumpS;
+
+	//------------------------------------------------------------------------------------------------
+	override static void InitInfo(WorldSystemInfo outInfo)
+	{
+		outInfo
+			.SetAbstract(false)
+			.SetLocation(ESystemLocation.Both)
+			.AddPoint(ESystemPoint.Frame);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	override protected void OnInit()
+	{
+		CAV_Perf.s_Enabled = m_Enabled || System.IsCLIParam("cavPerf");
+		m_NextDumpS = m_DumpIntervalS;
+		Enable(CAV_Perf.s_Enabled);
+
+		if (CAV_Perf.s_Enabled)
+			PrintFormat("[CAV_Perf] Enabled, dumping every %1 s to %2", m_DumpIntervalS, m_OutputPath);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	override protected void OnCleanup()
+	{
+		if (CAV_Perf.s_Enabled)
+			CAV_Perf.Dump(m_OutputPath, GetWorld().GetWorldTime() * 0.001);
+
+		CAV_Perf.s_Enabled = false;
+	}
+
+	//------------------------------------------------------------------------------------------------
+	override protected void OnUpdate(ESystemPoint point)
+	{
+		float nowS = GetWorld().GetWorldTime() * 0.001;
+		if (nowS < m_NextDumpS) return;
+
+		m_NextDumpS = nowS + m_DumpIntervalS;
+		CAV_Perf.Dump(m_OutputPath, nowS);
+	}
+}
@@ -2,7 +2,7 @@
 // CAV_RadioAutoTuneComponent.c  (updated)
 // - Channel 0 -> Player's group frequency (via SCR_GroupsManagerComponent / SCR_AIGroup)
 // - Channel 1 -> Faction frequency
-// - Uses 2-arg inventory hook; retries until faction ready; optional debug
+// - Per-prefab settings + registration only; CAV_RadioTuningSystem does the work
 // -----------------------------------------------------------------------------
 
 // Optional: small settings component (fallback if you want per-prefab config)
@@ -51,20 +51,10 @@ class CAV_RadioAutoTuneComponent : ScriptComponent
 	[Attribute(defvalue: "0", uiwidget: UIWidgets.CheckBox, desc: "Run on clients (for local testing)")]
 	protected bool m_RunOnClient;
 
-	// --- State ---------------------------------------------------------------
-	protected IEntity m_Owner;
-	protected ScriptedInventoryStorageManagerComponent m_InvMgr;  // 2-arg invoker
-	protected InventoryStorageManagerComponent m_InvMgrBase;
-
-	// Faction resolve retry
-	protected int m_FactionRetry = 0;
-	protected const int MAX_FACTION_RETRY = 20;   // ~4s if 200ms steps
-
 	// --- Lifecycle -----------------------------------------------------------
 	override protected void OnPostInit(IEntity owner)
 	{
 		super.OnPostInit(owner);
-		m_Owner = owner;
 
 		if (m_Debug) Print("[CAV_RadioAutoTune] OnPostInit");
 
@@ -74,285 +64,38 @@ class CAV_RadioAutoTuneComponent : ScriptComponent
 			return;
 		}
 
-		LocateInvMgr();
-		GetGame().GetCallqueue().CallLater(DeferredHook, 50, false);
+		CAV_RadioTuningSystem system = CAV_RadioTuningSystem.GetInstance();
+		if (system)
+			system.Register(this);
+		else if (m_Debug)
+			Print("[CAV_RadioAutoTune] CAV_RadioTuningSystem not found; is it in ChimeraSystemsConfig?");
 	}
 
 	override protected void OnDelete(IEntity owner)
 	{
-		if (m_InvMgr && m_InvMgr.m_OnItemAddedInvoker)
-			m_InvMgr.m_OnItemAddedInvoker.Remove(OnItemAdded);
+		CAV_RadioTuningSystem system = CAV_RadioTuningSystem.GetInstance();
+		if (system)
+			system.Unregister(this);
 
 		super.OnDelete(owner);
 	}
 
-	protected void DeferredHook()
-	{
-		if (m_Debug) Print("[CAV_RadioAutoTune] DeferredHook");
-
-		LocateInvMgr();
-		if (m_InvMgr && m_InvMgr.m_OnItemAddedInvoker)
-		{
-			m_InvMgr.m_OnItemAddedInvoker.Insert(OnItemAdded);
-			if (m_Debug) Print("[CAV_RadioAutoTune] Subscribed to 2-arg m_OnItemAddedInvoker");
-		}
-		else if (m_Debug) Print("[CAV_RadioAutoTune] Inventory manager / invoker not found");
-
-		WaitForFactionThenRetune();
-	}
-
-	// --- Inventory hookup ----------------------------------------------------
-	protected void LocateInvMgrOn(IEntity ent)
-	{
-		if (!ent) return;
-		if (!m_InvMgr) m_InvMgr = ScriptedInventoryStorageManagerComponent.Cast(ent.FindComponent(ScriptedInventoryStorageManagerComponent));
-	}
-
-	protected void ScanChildrenForInvMgr(IEntity ent)
-	{
-		IEntity c = ent.GetChildren();
-		while (!m_InvMgr && c)
-		{
-			LocateInvMgrOn(c);
-			c = c.GetSibling();
-		}
-	}
-
-	protected void LocateInvMgr()
-	{
-		LocateInvMgrOn(m_Owner);
-		if (!m_InvMgr) ScanChildrenForInvMgr(m_Owner);
-
-		m_InvMgrBase = InventoryStorageManagerComponent.Cast(m_InvMgr);
-
-		if (m_Debug)
-			PrintFormat("[CAV_RadioAutoTune] LocateInvMgr -> inv=%1 base=%2", m_InvMgr, m_InvMgrBase);
-	}
-
-	// --- Invoker handler (2 args) -------------------------------------------
-	void OnItemAdded(IEntity item, BaseInventoryStorageComponent storage)
-	{
-		if (m_Debug) PrintFormat("[CAV_RadioAutoTune] OnItemAdded item=%1 storage=%2", item, storage);
-
-		if (!item) return;
-		BaseRadioComponent radio = BaseRadioComponent.Cast(item.FindComponent(BaseRadioComponent));
-		if (radio) RetuneRadioBoth(radio);
-	}
-
-	// --- Retune flow ---------------------------------------------------------
-	protected void WaitForFactionThenRetune()
-	{
-		SCR_Faction fac = ResolveFactionOnce();
-		if (fac)
-		{
-			if (m_Debug) PrintFormat("[CAV_RadioAutoTune] Faction resolved: %1", fac);
-			RetuneAllRadios();
-			return;
-		}
-
-		if (m_FactionRetry < MAX_FACTION_RETRY)
-		{
-			m_FactionRetry++;
-			if (m_Debug) PrintFormat("[CAV_RadioAutoTune] ResolveFaction failed (try %1/%2) — retrying...", m_FactionRetry, MAX_FACTION_RETRY);
-			GetGame().GetCallqueue().CallLater(WaitForFactionThenRetune, 200, false);
-		}
-		else if (m_Debug) Print("[CAV_RadioAutoTune] ResolveFaction failed — giving up");
-	}
-
-	protected void RetuneAllRadios()
-	{
-		if (!m_InvMgrBase) return;
-
-		array<IEntity> withComps = {};
-		array<typename> want = { BaseRadioComponent };
-		m_InvMgrBase.FindItemsWithComponents(withComps, want);
-
-		if (m_Debug) PrintFormat("[CAV_RadioAutoTune] RetuneAllRadios count=%1", withComps.Count());
-
-		foreach (IEntity it : withComps)
-		{
-			BaseRadioComponent radio = BaseRadioComponent.Cast(it.FindComponent(BaseRadioComponent));
-			if (radio) RetuneRadioBoth(radio);
-		}
-	}
-
-	protected void RetuneRadioBoth(BaseRadioComponent radio)
-	{
-		if (!radio) return;
-
-		// --- GROUP on channel m_GroupChannelIndex ----------------------------
-		if (radio.TransceiversCount() > m_GroupChannelIndex)
-		{
-			BaseTransceiver chG = radio.GetTransceiver(m_GroupChannelIndex);
-			if (chG)
-			{
-				int gFreq; string gKey;
-				if (ResolveGroupRadio(gFreq, gKey))
-				{
-					int gMin = chG.GetMinFrequency();
-					int gMax = chG.GetMaxFrequency();
-					if (gFreq < gMin) gFreq = gMin;
-					if (gFreq > gMax) gFreq = gMax;
-
-					chG.SetFrequency(gFreq);
-					if (m_PreferGroupEncryption && gKey != "") radio.SetEncryptionKey(gKey);
-					if (m_Debug) PrintFormat("[CAV_RadioAutoTune] Group ch%1 -> %2 kHz", m_GroupChannelIndex, gFreq);
-				}
-				else if (m_Debug) Print("[CAV_RadioAutoTune] No group frequency found");
-			}
-		}
-		else if (m_Debug)
-			PrintFormat("[CAV_RadioAutoTune] Radio has %1 transceivers; group index %2 invalid", radio.TransceiversCount(), m_GroupChannelIndex);
-
-		// --- FACTION on channel m_FactionChannelIndex ------------------------
-		if (radio.TransceiversCount() > m_FactionChannelIndex)
-		{
-			BaseTransceiver chF = radio.GetTransceiver(m_FactionChannelIndex);
-			if (chF)
-			{
-				SCR_Faction fac = ResolveFactionOnce();
-				if (fac)
-				{
-					int fFreq = fac.GetFactionRadioFrequency();
-					int fMin = chF.GetMinFrequency();
-					int fMax = chF.GetMaxFrequency();
-					if (fFreq < fMin) fFreq = fMin;
-					if (fFreq > fMax) fFreq = fMax;
-
-					chF.SetFrequency(fFreq);
-					if (m_SyncFactionEncryption) radio.SetEncryptionKey(fac.GetFactionRadioEncryptionKey());
-					if (m_Debug) PrintFormat("[CAV_RadioAutoTune] Faction ch%1 -> %2 kHz", m_FactionChannelIndex, fFreq);
-				}
-				else if (m_Debug) Print("[CAV_RadioAutoTune] ResolveFaction failed inside RetuneRadioBoth");
-			}
-		}
-		else if (m_Debug)
-			PrintFormat("[CAV_RadioAutoTune] Radio has %1 transceivers; faction index %2 invalid", radio.TransceiversCount(), m_FactionChannelIndex);
-	}
-
-	// --- Group frequency resolution -----------------------------------------
-	// Order: explicit override -> player's live group -> fallback settings component
-	protected bool ResolveGroupRadio(out int freqKHz, out string key)
-	{
-		// 1) Explicit override
-		if (m_GroupFreqOverrideKHz > 0)
-		{
-			freqKHz = m_GroupFreqOverrideKHz; key = ""; return true;
-		}
-
-		// 2) Player's current group via GroupsManager (preferred)
-		PlayerManager pm = GetGame().GetPlayerManager();
-		if (pm)
-		{
-			int pid = pm.GetPlayerIdFromControlledEntity(m_Owner);
-			if (pid != 0)
-			{
-				SCR_GroupsManagerComponent gm = SCR_GroupsManagerComponent.GetInstance();
-				if (gm)
-				{
-					SCR_AIGroup group = gm.GetPlayerGroup(pid);
-					if (group)
-					{
-						int liveFreq = group.GetRadioFrequency(); // kHz
-						if (m_Debug) PrintFormat("[CAV_RadioAutoTune] Group from GM: id=%1 freq=%2", group.GetGroupID(), liveFreq);
-						if (liveFreq > 0) { freqKHz = liveFreq; key = ""; return true; }
-					}
-				}
-			}
-		}
-
-		// 3) Fallback: a nearby CAV_GroupRadioSettingsComponent
-		CAV_GroupRadioSettingsComponent g = FindGroupSettings();
-		if (g && g.GetGroupFrequencyKHz() > 0)
-		{
-			freqKHz = g.GetGroupFrequencyKHz();
-			if (!g.HasGroupEncryptionKey(key)) key = "";
-			return true;
-		}
-
-		// Nothing found
-		freqKHz = 0; key = ""; return false;
-	}
-
-	protected CAV_GroupRadioSettingsComponent FindGroupSettings()
-	{
-		CAV_GroupRadioSettingsComponent g = CAV_GroupRadioSettingsComponent.Cast(m_Owner.FindComponent(CAV_GroupRadioSettingsComponent));
-		if (g) return g;
-
-		IEntity p = m_Owner.GetParent();
-		while (p)
-		{
-			g = CAV_GroupRadioSettingsComponent.Cast(p.FindComponent(CAV_GroupRadioSettingsComponent));
-			if (g) return g;
-			p = p.GetParent();
-		}
-
-		IEntity c = m_Owner.GetChildren();
-		while (c)
-		{
-			g = CAV_GroupRadioSettingsComponent.Cast(c.FindComponent(CAV_GroupRadioSettingsComponent));
-			if (g) return g;
-			c = c.GetSibling();
-		}
-		return null;
-	}
-
-	// --- Faction helpers -----------------------------------------------------
-	protected SCR_FactionAffiliationComponent FindAffiliationComp()
-	{
-		SCR_FactionAffiliationComponent aff = SCR_FactionAffiliationComponent.Cast(m_Owner.FindComponent(SCR_FactionAffiliationComponent));
-		if (aff) return aff;
-
-		IEntity p = m_Owner.GetParent();
-		while (p)
-		{
-			aff = SCR_FactionAffiliationComponent.Cast(p.FindComponent(SCR_FactionAffiliationComponent));
-			if (aff) return aff;
-			p = p.GetParent();
-		}
-
-		IEntity c = m_Owner.GetChildren();
-		while (c)
-		{
-			aff = SCR_FactionAffiliationComponent.Cast(c.FindComponent(SCR_FactionAffiliationComponent));
-			if (aff) return aff;
-			c = c.GetSibling();
-		}
-
-		return null;
-	}
-
-	protected SCR_Faction ResolveFactionOnce()
-	{
-		SCR_FactionAffiliationComponent aff = FindAffiliationComp();
-		if (aff)
-		{
-			Faction f = aff.GetAffiliatedFaction();
-			if (f)
-			{
-				SCR_Faction sf = SCR_Faction.Cast(f);
-				if (sf) return sf;
-			}
-		}
-
-		PlayerManager pm = GetGame().GetPlayerManager();
-		if (pm)
-		{
-			int pid = pm.GetPlayerIdFromControlledEntity(m_Owner);
-			if (pid != 0)
-			{
-				SCR_Faction pf = SCR_Faction.Cast(SCR_FactionManager.SGetPlayerFaction(pid));
-				if (pf) return pf;
-			}
-		}
-		return null;
-	}
+	// --- Settings ------------------------------------------------------------
+	int  GetGroupChannelIndex()        { return m_GroupChannelIndex; }
+	int  GetFactionChannelIndex()      { return m_FactionChannelIndex; }
+	bool ShouldSyncFactionEncryption() { return m_SyncFactionEncryption; }
+	bool PrefersGroupEncryption()      { return m_PreferGroupEncryption; }
+	int  GetGroupFreqOverrideKHz()     { return m_GroupFreqOverrideKHz; }
+	bool IsDebug()                     { return m_Debug; }
 
 	// --- Utility -------------------------------------------------------------
 	void ForceRetune()
 	{
 		if (!Replication.IsServer() && !m_RunOnClient) return;
 		if (m_Debug) Print("[CAV_RadioAutoTune] ForceRetune");
-		RetuneAllRadios();
+
+		CAV_RadioTuningSystem system = CAV_RadioTuningSystem.GetInstance();
+		if (system)
+			system.RequestRetune(GetOwner());
 	}
-}
\ No newline at end of file
+}
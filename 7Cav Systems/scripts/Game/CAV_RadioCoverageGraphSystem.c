@@ -0,0 +1,430 @@
+// -----------------------------------------------------------------------------
+// CAV_RadioCoverageGraphSystem.c
+// - Cached reach graph over every SCR_CoverageRadioComponent (relays, bases,
+//   HQs). A node reaches another when the other is inside its range; both
+//   directions are kept, found through a CAV_SpatialGrid at registration and
+//   redone for a node only when its position or range changes
+// - Per encryption, the relay network is every node of that encryption linked
+//   both ways to one of its sources. Relays are BOTH_WAYS; any other node, of
+//   whatever faction or none, gets RECEIVE when a relay reaches it, SEND when
+//   it reaches a relay, BOTH_WAYS when both, as vanilla does
+// - A capture only marks the old and new encryption dirty. Next frame each is
+//   recomputed once and only nodes whose status changed are written, so
+//   replication carries just those changes
+// - Several captures in one window are merged per encryption
+// - Vanilla full-network recomputes still run; afterwards the graph re-reads
+//   every node and takes the statuses vanilla wrote as its baseline
+// -----------------------------------------------------------------------------
+
+class CAV_RadioCoverageGraphSystem : GameSystem
+{
+	[Attribute(defvalue: "1", uiwidget: UIWidgets.CheckBox, desc: "Update radio coverage incrementally from a cached graph")]
+	protected bool m_Active;
+
+	[Attribute(defvalue: "1000", uiwidget: UIWidgets.EditBox, desc: "Transmitter grid cell size (m)", params: "100 10000 50")]
+	protected float m_CellSize;
+
+	[Attribute(defvalue: "2", uiwidget: UIWidgets.EditBox, desc: "Max encryptions recomputed per frame", params: "1 16 1")]
+	protected int m_MaxEncryptionsPerFrame;
+
+	// --- Nodes (parallel, indexed by node id; ids never reused) --------------
+	protected ref array<SCR_CoverageRadioComponent> m_Components = {};
+	protected ref array<vector> m_Positions = {};
+	protected ref array<float> m_Ranges = {};
+	protected ref array<bool> m_IsSource = {};
+	protected ref array<string> m_Encryptions = {};
+	protected ref array<ref array<int>> m_Out = {};     // nodes inside this node's range
+	protected ref array<ref array<int>> m_In = {};      // nodes whose range holds this node
+	protected ref map<SCR_CoverageRadioComponent, int> m_IdByComponent = new map<SCR_CoverageRadioComponent, int>();
+	protected ref CAV_SpatialGrid m_Grid;
+	protected float m_MaxRange;
+
+	// --- Coverage, per encryption and node id --------------------------------
+	protected ref map<string, ref array<int>> m_Status = new map<string, ref array<int>>();
+
+	// --- Pending work --------------------------------------------------------
+	protected ref array<string> m_DirtyEncryptions = {};
+
+	protected ref array<int> m_Candidates = {};
+	protected ref array<int> m_Relays = {};
+	protected ref array<int> m_RelayStamp = {};
+	protected ref array<int> m_ReceiveStamp = {};
+	protected ref array<int> m_SendStamp = {};
+	protected int m_Stamp;
+
+	//------------------------------------------------------------------------------------------------
+	override static void InitInfo(WorldSystemInfo outInfo)
+	{
+		outInfo
+			.SetAbstract(false)
+			.SetLocation(ESystemLocation.Server)
+			.AddPoint(ESystemPoint.Frame);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	static CAV_RadioCoverageGraphSystem GetInstance()
+	{
+		World world = GetGame().GetWorld();
+		if (!world) return null;
+		return CAV_RadioCoverageGraphSystem.Cast(world.FindSystem(CAV_RadioCoverageGraphSystem));
+	}
+
+	//------------------------------------------------------------------------------------------------
+	override protected void OnInit()
+	{
+		m_Grid = new CAV_SpatialGrid(m_CellSize);
+		Enable(false);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	bool IsActive()
+	{
+		return m_Active;
+	}
+
+	// --- Registration --------------------------------------------------------
+	void Register(notnull SCR_CoverageRadioComponent comp)
+	{
+		if (m_IdByComponent.Contains(comp)) return;
+
+		IEntity owner = comp.GetOwner();
+		int id = m_Components.Insert(comp);
+		m_Positions.Insert(owner.GetOrigin());
+		m_Ranges.Insert(comp.CAV_GetRange());
+		m_IsSource.Insert(comp.CAV_IsSource());
+		m_Encryptions.Insert(comp.CAV_GetEncryption());
+		m_Out.Insert(new array<int>());
+		m_In.Insert(new array<int>());
+		m_RelayStamp.Insert(0);
+		m_ReceiveStamp.Insert(0);
+		m_SendStamp.Insert(0);
+		m_IdByComponent.Insert(comp, id);
+
+		foreach (string encryption, array<int> statuses : m_Status)
+		{
+			statuses.Insert(SCR_ERadioCoverageStatus.NONE);
+		}
+
+		Link(id);
+		m_Grid.Insert(id, m_Positions[id]);
+
+		// A new node can be reached by, or reach, any encryption's relays
+		MarkAllDirty();
+		MarkDirty(m_Encryptions[id]);
+		CAV_Perf.Sample("radiograph.nodes", m_IdByComponent.Count());
+	}
+
+	// The longest range seen bounds the query for nodes that reach this one
+	protected void Link(int id)
+	{
+		float range = m_Ranges[id];
+		m_MaxRange = Math.Max(m_MaxRange, range);
+
+		m_Candidates.Clear();
+		m_Grid.QueryRadius(m_Positions[id], m_MaxRange, m_Candidates);
+		foreach (int other : m_Candidates)
+		{
+			if (other == id || !m_Components[other]) continue;
+
+			float d = vector.Distance(m_Positions[id], m_Positions[other]);
+			if (d <= range)
+			{
+				m_Out[id].Insert(other);
+				m_In[other].Insert(id);
+			}
+			if (d <= m_Ranges[other])
+			{
+				m_Out[other].Insert(id);
+				m_In[id].Insert(other);
+			}
+		}
+	}
+
+	protected void Unlink(int id)
+	{
+		foreach (int other : m_Out[id])
+		{
+			m_In[other].RemoveItem(id);
+		}
+		foreach (int other : m_In[id])
+		{
+			m_Out[other].RemoveItem(id);
+		}
+		m_Out[id].Clear();
+		m_In[id].Clear();
+	}
+
+	void Unregister(SCR_CoverageRadioComponent comp)
+	{
+		int id;
+		if (!m_IdByComponent.Find(comp, id)) return;
+
+		m_IdByComponent.Remove(comp);
+		m_Grid.Remove(id, m_Positions[id]);
+		Unlink(id);
+		m_Components[id] = null;
+
+		// Anything it relayed for may lose coverage
+		MarkAllDirty();
+	}
+
+	// --- Change intake -------------------------------------------------------
+	// Owner switched faction (base captured, relay taken) or source status flipped
+	void OnNodeChanged(notnull SCR_CoverageRadioComponent comp)
+	{
+		int id;
+		if (!m_IdByComponent.Find(comp, id)) return;
+
+		string previous = m_Encryptions[id];
+		m_Encryptions[id] = comp.CAV_GetEncryption();
+		m_IsSource[id] = comp.CAV_IsSource();
+
+		// The node keeps whatever coverage the old network gives it as a plain node
+		MarkDirty(previous);
+		MarkDirty(m_Encryptions[id]);
+
+		CAV_Perf.Count("radiograph.changes");
+	}
+
+	// Vanilla just recomputed the whole network: re-read every node and take
+	// the statuses it wrote as the baseline for the next incremental update
+	void RefreshAll()
+	{
+		CAV_PerfScope perfScope = CAV_Perf.Scope("radiograph.refresh_ms");
+
+		int relinked = 0;
+		foreach (int id, SCR_CoverageRadioComponent comp : m_Components)
+		{
+			if (!comp) continue;
+
+			vector pos = comp.GetOwner().GetOrigin();
+			float range = comp.CAV_GetRange();
+			if (pos != m_Positions[id] || range != m_Ranges[id])
+			{
+				m_Grid.Remove(id, m_Positions[id]);
+				Unlink(id);
+				m_Positions[id] = pos;
+				m_Ranges[id] = range;
+				Link(id);
+				m_Grid.Insert(id, pos);
+				relinked++;
+			}
+
+			m_IsSource[id] = comp.CAV_IsSource();
+			m_Encryptions[id] = comp.CAV_GetEncryption();
+			if (!m_Encryptions[id].IsEmpty())
+				GetStatuses(m_Encryptions[id]);
+		}
+
+		foreach (string encryption, array<int> statuses : m_Status)
+		{
+			foreach (int id, SCR_CoverageRadioComponent comp : m_Components)
+			{
+				if (comp)
+					statuses[id] = comp.GetCoverageByEncryption(encryption);
+			}
+		}
+
+		m_DirtyEncryptions.Clear();
+		CAV_Perf.Count("radiograph.relinked", relinked);
+	}
+
+	protected void MarkDirty(string encryption)
+	{
+		if (encryption.IsEmpty() || m_DirtyEncryptions.Contains(encryption)) return;
+
+		m_DirtyEncryptions.Insert(encryption);
+		Enable(true);
+	}
+
+	protected void MarkAllDirty()
+	{
+		foreach (string encryption, array<int> statuses : m_Status)
+		{
+			MarkDirty(encryption);
+		}
+	}
+
+	// Status per node id for an encryption, created on first use
+	protected array<int> GetStatuses(string encryption)
+	{
+		array<int> statuses = m_Status.Get(encryption);
+		if (statuses) return statuses;
+
+		statuses = {};
+		foreach (SCR_CoverageRadioComponent comp : m_Components)
+		{
+			statuses.Insert(SCR_ERadioCoverageStatus.NONE);
+		}
+		m_Status.Insert(encryption, statuses);
+		return statuses;
+	}
+
+	// --- Frame update --------------------------------------------------------
+	override protected void OnUpdate(ESystemPoint point)
+	{
+		CAV_PerfScope perfScope = CAV_Perf.Scope("radiograph.frame_ms");
+
+		int recomputed = 0;
+		int flipped = 0;
+		while (!m_DirtyEncryptions.IsEmpty() && recomputed < m_MaxEncryptionsPerFrame)
+		{
+			string encryption = m_DirtyEncryptions[0];
+			m_DirtyEncryptions.RemoveOrdered(0);
+
+			flipped += Recompute(encryption);
+			recomputed++;
+		}
+
+		CAV_Perf.Count("radiograph.floods", recomputed);
+		CAV_Perf.Count("radiograph.flipped", flipped);
+
+		if (m_DirtyEncryptions.IsEmpty())
+			Enable(false);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	// Flood the encryption's relay network out from its sources, then give every
+	// node the directions it has to that network and write only the changes
+	protected int Recompute(string encryption)
+	{
+		m_Stamp++;
+		m_Relays.Clear();
+
+		foreach (int id, SCR_CoverageRadioComponent comp : m_Components)
+		{
+			if (!comp || !m_IsSource[id] || m_Encryptions[id] != encryption) continue;
+
+			m_RelayStamp[id] = m_Stamp;
+			m_Relays.Insert(id);
+		}
+
+		// Only nodes of the encryption relay it, and only over links that work both ways
+		for (int i = 0; i < m_Relays.Count(); i++)
+		{
+			int node = m_Relays[i];
+			foreach (int other : m_Out[node])
+			{
+				if (m_RelayStamp[other] == m_Stamp) continue;
+				if (!m_Components[other] || m_Encryptions[other] != encryption) continue;
+				if (!m_In[node].Contains(other)) continue;
+
+				m_RelayStamp[other] = m_Stamp;
+				m_Relays.Insert(other);
+			}
+		}
+
+		foreach (int relay : m_Relays)
+		{
+			foreach (int other : m_Out[relay])
+			{
+				m_ReceiveStamp[other] = m_Stamp;
+			}
+			foreach (int other : m_In[relay])
+			{
+				m_SendStamp[other] = m_Stamp;
+			}
+		}
+
+		array<int> statuses = GetStatuses(encryption);
+		int flipped = 0;
+		foreach (int id, SCR_CoverageRadioComponent comp : m_Components)
+		{
+			if (!comp) continue;
+
+			SCR_ERadioCoverageStatus status = SCR_ERadioCoverageStatus.NONE;
+			bool receives = m_ReceiveStamp[id] == m_Stamp;
+			bool sends = m_SendStamp[id] == m_Stamp;
+			if (m_RelayStamp[id] == m_Stamp || (receives && sends))
+				status = SCR_ERadioCoverageStatus.BOTH_WAYS;
+			else if (receives)
+				status = SCR_ERadioCoverageStatus.RECEIVE;
+			else if (sends)
+				status = SCR_ERadioCoverageStatus.SEND;
+
+			if (statuses[id] == status) continue;
+
+			statuses[id] = status;
+			comp.SetCoverageByEncryption(encryption, status);
+			flipped++;
+		}
+
+		CAV_Perf.Sample("radiograph.region", m_Relays.Count());
+		return flipped;
+	}
+}
+
+// ---- Graph node hooks
+modded class SCR_CoverageRadioComponent
+{
+	override void EOnInit(IEntity owner)
+	{
+		super.EOnInit(owner);
+
+		if (!Replication.IsServer())
+			return;
+
+		CAV_RadioCoverageGraphSystem graph = CAV_RadioCoverageGraphSystem.GetInstance();
+		if (!graph || !graph.IsActive())
+			return;
+
+		graph.Register(this);
+
+		FactionAffiliationComponent affiliation = FactionAffiliationComponent.Cast(owner.FindComponent(FactionAffiliationComponent));
+		if (affiliation)
+			affiliation.GetOnFactionChanged().Insert(CAV_OnOwnerFactionChanged);
+	}
+
+	override void OnDelete(IEntity owner)
+	{
+		CAV_RadioCoverageGraphSystem graph = CAV_RadioCoverageGraphSystem.GetInstance();
+		if (graph)
+			graph.Unregister(this);
+
+		super.OnDelete(owner);
+	}
+
+	protected void CAV_OnOwnerFactionChanged(FactionAffiliationComponent owner, Faction previousFaction, Faction newFaction)
+	{
+		CAV_RadioCoverageGraphSystem graph = CAV_RadioCoverageGraphSystem.GetInstance();
+		if (graph)
+			graph.OnNodeChanged(this);
+	}
+
+	float CAV_GetRange()
+	{
+		return GetRadioRange();
+	}
+
+	bool CAV_IsSource()
+	{
+		return m_bIsSource;
+	}
+
+	// Encryption of the owner's current faction; empty when unaffiliated
+	string CAV_GetEncryption()
+	{
+		FactionAffiliationComponent affiliation = FactionAffiliationComponent.Cast(GetOwner().FindComponent(FactionAffiliationComponent));
+		if (!affiliation)
+			return string.Empty;
+
+		SCR_Faction faction = SCR_Faction.Cast(affiliation.GetAffiliatedFaction());
+		if (!faction)
+			return string.Empty;
+
+		return faction.GetFactionRadioEncryptionKey();
+	}
+}
+
+// ---- Vanilla full-network recomputes stay authoritative; the graph resyncs after them
+modded class SCR_RadioCoverageSystem
+{
+	override static void UpdateAll(bool forceUpdate = false)
+	{
+		super.UpdateAll(forceUpdate);
+
+		CAV_RadioCoverageGraphSystem graph = CAV_RadioCoverageGraphSystem.GetInstance();
+		if (graph && graph.IsActive())
+			graph.RefreshAll();
+	}
+}
@@ -0,0 +1,768 @@
+// -----------------------------------------------------------------------------
+// CAV_RadioTuningSystem.c
+// - One game system for every CAV_RadioAutoTuneComponent owner
+// - Faction/group/spawn/inventory events mark radios dirty
+// - Dirty radios are retuned from a flat queue under a per-frame budget
+// - Group frequency changes are pushed straight to that group's radios
+// -----------------------------------------------------------------------------
+
+// ---- Resolved tuning context (cached per owner)
+// Everything a retune needs, resolved once and reused until a faction/group
+// event invalidates it. Clamped frequencies are cached for the last transceiver
+// range seen, which covers the usual case of one radio type per loadout.
+class CAV_RadioTuningContext
+{
+	SCR_Faction m_Faction;
+	int    m_FactionFreqKHz;
+	string m_FactionKey;
+
+	bool   m_HasGroup;
+	int    m_GroupFreqKHz;
+	string m_GroupKey;
+	SCR_AIGroup m_Group;   // set only when the frequency comes from the live group
+
+	protected int m_ClampMin = -1;
+	protected int m_ClampMax = -1;
+	protected int m_ClampedGroupKHz;
+	protected int m_ClampedFactionKHz;
+
+	protected void UpdateClamp(BaseTransceiver tsv)
+	{
+		int min = tsv.GetMinFrequency();
+		int max = tsv.GetMaxFrequency();
+		if (min == m_ClampMin && max == m_ClampMax) return;
+
+		m_ClampMin = min;
+		m_ClampMax = max;
+		m_ClampedGroupKHz = Math.ClampInt(m_GroupFreqKHz, min, max);
+		m_ClampedFactionKHz = Math.ClampInt(m_FactionFreqKHz, min, max);
+	}
+
+	void SetGroupFrequency(int freqKHz)
+	{
+		m_GroupFreqKHz = freqKHz;
+		m_ClampMin = -1;
+		m_ClampMax = -1;
+	}
+
+	int GetGroupFrequency(BaseTransceiver tsv)
+	{
+		UpdateClamp(tsv);
+		return m_ClampedGroupKHz;
+	}
+
+	int GetFactionFrequency(BaseTransceiver tsv)
+	{
+		UpdateClamp(tsv);
+		return m_ClampedFactionKHz;
+	}
+}
+
+// ---- Per-owner record
+// Holds what used to live on each component: located managers, the radios the
+// owner carries and the cached context.
+class CAV_RadioTuningOwner
+{
+	IEntity m_Owner;
+	CAV_RadioAutoTuneComponent m_Settings;
+	ScriptedInventoryStorageManagerComponent m_InvMgr;  // 2-arg invoker
+	SCR_FactionAffiliationComponent m_AffiliationComp;
+	SCR_AIGroup m_Group;   // group this owner is indexed under in the system
+	bool m_Hooked;
+
+	ref array<BaseRadioComponent> m_Radios = {};
+
+	protected ref CAV_RadioTuningContext m_Context;  // null = dirty
+	protected CAV_GroupRadioSettingsComponent m_GroupSettings;
+	protected bool m_GroupSettingsSearched;
+
+	void CAV_RadioTuningOwner(CAV_RadioAutoTuneComponent settings)
+	{
+		m_Settings = settings;
+		m_Owner = settings.GetOwner();
+	}
+
+	bool IsDebug()
+	{
+		return m_Settings && m_Settings.IsDebug();
+	}
+
+	int GetPlayerId()
+	{
+		PlayerManager pm = GetGame().GetPlayerManager();
+		if (!pm) return 0;
+		return pm.GetPlayerIdFromControlledEntity(m_Owner);
+	}
+
+	// --- Inventory -----------------------------------------------------------
+	void LocateInvMgr()
+	{
+		if (m_InvMgr) return;
+
+		m_InvMgr = ScriptedInventoryStorageManagerComponent.Cast(m_Owner.FindComponent(ScriptedInventoryStorageManagerComponent));
+
+		IEntity c = m_Owner.GetChildren();
+		while (!m_InvMgr && c)
+		{
+			m_InvMgr = ScriptedInventoryStorageManagerComponent.Cast(c.FindComponent(ScriptedInventoryStorageManagerComponent));
+			c = c.GetSibling();
+		}
+
+		if (IsDebug()) PrintFormat("[CAV_RadioAutoTune] LocateInvMgr -> inv=%1", m_InvMgr);
+	}
+
+	// One full inventory scan at hookup; afterwards the list follows add/remove events
+	void CollectRadios()
+	{
+		m_Radios.Clear();
+		if (!m_InvMgr) return;
+
+		array<IEntity> withComps = {};
+		array<typename> want = { BaseRadioComponent };
+		m_InvMgr.FindItemsWithComponents(withComps, want);
+
+		foreach (IEntity it : withComps)
+		{
+			BaseRadioComponent radio = BaseRadioComponent.Cast(it.FindComponent(BaseRadioComponent));
+			if (radio) m_Radios.Insert(radio);
+		}
+
+		if (IsDebug()) PrintFormat("[CAV_RadioAutoTune] CollectRadios count=%1", m_Radios.Count());
+	}
+
+	// --- Tuning context ------------------------------------------------------
+	void InvalidateContext()
+	{
+		m_Context = null;
+	}
+
+	// Cached context or null; never resolves
+	CAV_RadioTuningContext PeekContext()
+	{
+		return m_Context;
+	}
+
+	// Returns the cached context, resolving faction and group only when dirty.
+	// Null while the faction is still unknown (nothing is cached in that case).
+	CAV_RadioTuningContext GetContext()
+	{
+		if (m_Context) return m_Context;
+
+		SCR_Faction fac = ResolveFactionOnce();
+		if (!fac) return null;
+
+		CAV_RadioTuningContext ctx = new CAV_RadioTuningContext();
+		ctx.m_Faction = fac;
+		ctx.m_FactionFreqKHz = fac.GetFactionRadioFrequency();
+		ctx.m_FactionKey = fac.GetFactionRadioEncryptionKey();
+		ctx.m_HasGroup = ResolveGroupRadio(ctx.m_GroupFreqKHz, ctx.m_GroupKey, ctx.m_Group);
+
+		if (IsDebug()) PrintFormat("[CAV_RadioAutoTune] Context resolved: faction=%1 (%2 kHz) group=%3 (%4 kHz)", fac, ctx.m_FactionFreqKHz, ctx.m_HasGroup, ctx.m_GroupFreqKHz);
+
+		m_Context = ctx;
+		return m_Context;
+	}
+
+	// --- Retune --------------------------------------------------------------
+	// Channel-0 only; used when the owner's group changes frequency
+	void RetuneGroupChannel(CAV_RadioTuningContext ctx)
+	{
+		int groupIdx = m_Settings.GetGroupChannelIndex();
+		foreach (BaseRadioComponent radio : m_Radios)
+		{
+			if (!radio || radio.TransceiversCount() <= groupIdx) continue;
+
+			BaseTransceiver chG = radio.GetTransceiver(groupIdx);
+			if (chG)
+				chG.SetFrequency(ctx.GetGroupFrequency(chG));
+		}
+
+		if (IsDebug()) PrintFormat("[CAV_RadioAutoTune] Group ch%1 -> %2 kHz on %3 radios", groupIdx, ctx.m_GroupFreqKHz, m_Radios.Count());
+	}
+
+	void RetuneRadio(BaseRadioComponent radio, CAV_RadioTuningContext ctx)
+	{
+		int groupIdx = m_Settings.GetGroupChannelIndex();
+		int factionIdx = m_Settings.GetFactionChannelIndex();
+		int count = radio.TransceiversCount();
+
+		// --- GROUP on channel groupIdx ---------------------------------------
+		if (count > groupIdx)
+		{
+			BaseTransceiver chG = radio.GetTransceiver(groupIdx);
+			if (chG)
+			{
+				if (ctx.m_HasGroup)
+				{
+					int gFreq = ctx.GetGroupFrequency(chG);
+					chG.SetFrequency(gFreq);
+					if (m_Settings.PrefersGroupEncryption() && ctx.m_GroupKey != "") radio.SetEncryptionKey(ctx.m_GroupKey);
+					if (IsDebug()) PrintFormat("[CAV_RadioAutoTune] Group ch%1 -> %2 kHz", groupIdx, gFreq);
+				}
+				else if (IsDebug()) Print("[CAV_RadioAutoTune] No group frequency found");
+			}
+		}
+		else if (IsDebug())
+			PrintFormat("[CAV_RadioAutoTune] Radio has %1 transceivers; group index %2 invalid", count, groupIdx);
+
+		// --- FACTION on channel factionIdx -----------------------------------
+		if (count > factionIdx)
+		{
+			BaseTransceiver chF = radio.GetTransceiver(factionIdx);
+			if (chF)
+			{
+				int fFreq = ctx.GetFactionFrequency(chF);
+				chF.SetFrequency(fFreq);
+				if (m_Settings.ShouldSyncFactionEncryption()) radio.SetEncryptionKey(ctx.m_FactionKey);
+				if (IsDebug()) PrintFormat("[CAV_RadioAutoTune] Faction ch%1 -> %2 kHz", factionIdx, fFreq);
+			}
+		}
+		else if (IsDebug())
+			PrintFormat("[CAV_RadioAutoTune] Radio has %1 transceivers; faction index %2 invalid", count, factionIdx);
+	}
+
+	// --- Group frequency resolution -----------------------------------------
+	// Order: explicit override -> player's live group -> fallback settings component
+	protected bool ResolveGroupRadio(out int freqKHz, out string key, out SCR_AIGroup liveGroup)
+	{
+		liveGroup = null;
+
+		// 1) Explicit override
+		int overrideKHz = m_Settings.GetGroupFreqOverrideKHz();
+		if (overrideKHz > 0)
+		{
+			freqKHz = overrideKHz; key = ""; return true;
+		}
+
+		// 2) Player's current group via GroupsManager (preferred)
+		int pid = GetPlayerId();
+		if (pid != 0)
+		{
+			SCR_GroupsManagerComponent gm = SCR_GroupsManagerComponent.GetInstance();
+			if (gm)
+			{
+				SCR_AIGroup group = gm.GetPlayerGroup(pid);
+				if (group)
+				{
+					int liveFreq = group.GetRadioFrequency(); // kHz
+					if (IsDebug()) PrintFormat("[CAV_RadioAutoTune] Group from GM: id=%1 freq=%2", group.GetGroupID(), liveFreq);
+					if (liveFreq > 0) { freqKHz = liveFreq; key = ""; liveGroup = group; return true; }
+				}
+			}
+		}
+
+		// 3) Fallback: a nearby CAV_GroupRadioSettingsComponent (hierarchy scanned once)
+		if (!m_GroupSettingsSearched)
+		{
+			m_GroupSettings = FindGroupSettings();
+			m_GroupSettingsSearched = true;
+		}
+		CAV_GroupRadioSettingsComponent g = m_GroupSettings;
+		if (g && g.GetGroupFrequencyKHz() > 0)
+		{
+			freqKHz = g.GetGroupFrequencyKHz();
+			if (!g.HasGroupEncryptionKey(key)) key = "";
+			return true;
+		}
+
+		// Nothing found
+		freqKHz = 0; key = ""; return false;
+	}
+
+	protected CAV_GroupRadioSettingsComponent FindGroupSettings()
+	{
+		CAV_GroupRadioSettingsComponent g = CAV_GroupRadioSettingsComponent.Cast(m_Owner.FindComponent(CAV_GroupRadioSettingsComponent));
+		if (g) return g;
+
+		IEntity p = m_Owner.GetParent();
+		while (p)
+		{
+			g = CAV_GroupRadioSettingsComponent.Cast(p.FindComponent(CAV_GroupRadioSettingsComponent));
+			if (g) return g;
+			p = p.GetParent();
+		}
+
+		IEntity c = m_Owner.GetChildren();
+		while (c)
+		{
+			g = CAV_GroupRadioSettingsComponent.Cast(c.FindComponent(CAV_GroupRadioSettingsComponent));
+			if (g) return g;
+			c = c.GetSibling();
+		}
+		return null;
+	}
+
+	// --- Faction helpers -----------------------------------------------------
+	SCR_FactionAffiliationComponent FindAffiliationComp()
+	{
+		SCR_FactionAffiliationComponent aff = SCR_FactionAffiliationComponent.Cast(m_Owner.FindComponent(SCR_FactionAffiliationComponent));
+		if (aff) return aff;
+
+		IEntity p = m_Owner.GetParent();
+		while (p)
+		{
+			aff = SCR_FactionAffiliationComponent.Cast(p.FindComponent(SCR_FactionAffiliationComponent));
+			if (aff) return aff;
+			p = p.GetParent();
+		}
+
+		IEntity c = m_Owner.GetChildren();
+		while (c)
+		{
+			aff = SCR_FactionAffiliationComponent.Cast(c.FindComponent(SCR_FactionAffiliationComponent));
+			if (aff) return aff;
+			c = c.GetSibling();
+		}
+
+		return null;
+	}
+
+	protected SCR_Faction ResolveFactionOnce()
+	{
+		if (!m_AffiliationComp) m_AffiliationComp = FindAffiliationComp();
+		if (m_AffiliationComp)
+		{
+			SCR_Faction sf = SCR_Faction.Cast(m_AffiliationComp.GetAffiliatedFaction());
+			if (sf) return sf;
+		}
+
+		int pid = GetPlayerId();
+		if (pid != 0)
+		{
+			SCR_Faction pf = SCR_Faction.Cast(SCR_FactionManager.SGetPlayerFaction(pid));
+			if (pf) return pf;
+		}
+		return null;
+	}
+}
+
+// ---- The system
+class CAV_RadioTuningSystem : GameSystem
+{
+	[Attribute(defvalue: "32", uiwidget: UIWidgets.EditBox, desc: "Max radios retuned per frame", params: "1 1024 1")]
+	protected int m_MaxRadiosPerFrame;
+
+	[Attribute(defvalue: "16", uiwidget: UIWidgets.EditBox, desc: "Max new owners hooked up per frame", params: "1 256 1")]
+	protected int m_MaxHookupsPerFrame;
+
+	[Attribute(defvalue: "1", uiwidget: UIWidgets.EditBox, desc: "Max milliseconds of tuning work per frame", params: "1 50 1")]
+	protected int m_MaxFrameTimeMs;
+
+	// --- State ---------------------------------------------------------------
+	protected ref array<ref CAV_RadioTuningOwner> m_Owners = {};
+	protected ref map<IEntity, CAV_RadioTuningOwner> m_OwnerByEntity = new map<IEntity, CAV_RadioTuningOwner>();
+	protected ref map<FactionAffiliationComponent, CAV_RadioTuningOwner> m_OwnerByAffiliation = new map<FactionAffiliationComponent, CAV_RadioTuningOwner>();
+
+	// Group -> member owners, so a frequency change touches only that group's radios
+	protected ref map<SCR_AIGroup, ref array<CAV_RadioTuningOwner>> m_OwnersByGroup = new map<SCR_AIGroup, ref array<CAV_RadioTuningOwner>>();
+
+	// Owners registered this frame; hooked up from OnUpdate instead of a per-entity CallLater
+	protected ref array<CAV_RadioTuningOwner> m_PendingHookup = {};
+
+	// Flat dirty queue (parallel arrays), consumed from m_QueueHead
+	protected ref array<BaseRadioComponent> m_QueueRadios = {};
+	protected ref array<CAV_RadioTuningOwner> m_QueueOwners = {};
+	protected ref set<BaseRadioComponent> m_Queued = new set<BaseRadioComponent>();
+	protected int m_QueueHead;
+
+	protected bool m_GlobalHooked;
+	protected SCR_BaseGameMode m_GameMode;
+
+	//------------------------------------------------------------------------------------------------
+	override static void InitInfo(WorldSystemInfo outInfo)
+	{
+		// Both, so 'Run on clients' keeps working for local testing; clients never
+		// register anything unless that flag is set, so the system stays disabled there.
+		outInfo
+			.SetAbstract(false)
+			.SetLocation(ESystemLocation.Both)
+			.AddPoint(ESystemPoint.Frame);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	static CAV_RadioTuningSystem GetInstance()
+	{
+		World world = GetGame().GetWorld();
+		if (!world) return null;
+		return CAV_RadioTuningSystem.Cast(world.FindSystem(CAV_RadioTuningSystem));
+	}
+
+	//------------------------------------------------------------------------------------------------
+	override protected void OnInit()
+	{
+		Enable(false);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	override protected void OnCleanup()
+	{
+		UnhookGlobalEvents();
+
+		foreach (CAV_RadioTuningOwner rec : m_Owners)
+			UnhookOwner(rec);
+
+		m_Owners.Clear();
+		m_OwnerByEntity.Clear();
+		m_OwnerByAffiliation.Clear();
+		m_OwnersByGroup.Clear();
+		m_PendingHookup.Clear();
+		ClearQueue();
+	}
+
+	// --- Registration --------------------------------------------------------
+	void Register(CAV_RadioAutoTuneComponent comp)
+	{
+		IEntity owner = comp.GetOwner();
+		if (!owner || m_OwnerByEntity.Contains(owner)) return;
+
+		CAV_RadioTuningOwner rec = new CAV_RadioTuningOwner(comp);
+		m_Owners.Insert(rec);
+		m_OwnerByEntity.Insert(owner, rec);
+		m_PendingHookup.Insert(rec);
+
+		HookGlobalEvents();
+		Enable(true);
+	}
+
+	void Unregister(CAV_RadioAutoTuneComponent comp)
+	{
+		IEntity owner = comp.GetOwner();
+		CAV_RadioTuningOwner rec = m_OwnerByEntity.Get(owner);
+		if (!rec) return;
+
+		UnhookOwner(rec);
+		SetOwnerGroup(rec, null);
+		m_OwnerByEntity.Remove(owner);
+		m_PendingHookup.RemoveItem(rec);
+
+		// Queue entries hold weak refs; they go null once the record is released
+		m_Owners.RemoveItem(rec);
+	}
+
+	// Invalidate and retune everything the owner carries
+	void RequestRetune(IEntity owner)
+	{
+		CAV_RadioTuningOwner rec = m_OwnerByEntity.Get(owner);
+		if (rec)
+			MarkOwnerDirty(rec);
+	}
+
+	// --- Event hookup --------------------------------------------------------
+	protected void HookGlobalEvents()
+	{
+		if (!m_GlobalHooked)
+		{
+			m_GlobalHooked = true;
+			SCR_AIGroup.GetOnPlayerAdded().Insert(OnGroupPlayerAdded);
+			SCR_AIGroup.GetOnPlayerRemoved().Insert(OnGroupPlayerRemoved);
+			SCR_AIGroup.GetOnFrequencyChanged().Insert(OnGroupFrequencyChanged);
+		}
+
+		// Game mode may not exist yet for the first world-placed owners
+		if (!m_GameMode)
+		{
+			m_GameMode = SCR_BaseGameMode.Cast(GetGame().GetGameMode());
+			if (m_GameMode)
+				m_GameMode.GetOnPlayerSpawned().Insert(OnPlayerSpawned);
+		}
+	}
+
+	protected void UnhookGlobalEvents()
+	{
+		if (m_GlobalHooked)
+		{
+			m_GlobalHooked = false;
+			SCR_AIGroup.GetOnPlayerAdded().Remove(OnGroupPlayerAdded);
+			SCR_AIGroup.GetOnPlayerRemoved().Remove(OnGroupPlayerRemoved);
+			SCR_AIGroup.GetOnFrequencyChanged().Remove(OnGroupFrequencyChanged);
+		}
+
+		if (m_GameMode)
+		{
+			m_GameMode.GetOnPlayerSpawned().Remove(OnPlayerSpawned);
+			m_GameMode = null;
+		}
+	}
+
+	protected void HookOwner(CAV_RadioTuningOwner rec)
+	{
+		if (rec.m_Hooked || !rec.m_Owner) return;
+		rec.m_Hooked = true;
+
+		rec.LocateInvMgr();
+		if (rec.m_InvMgr)
+		{
+			rec.m_InvMgr.m_OnItemAddedInvoker.Insert(OnItemAdded);
+			rec.m_InvMgr.m_OnItemRemovedInvoker.Insert(OnItemRemoved);
+		}
+		else if (rec.IsDebug()) Print("[CAV_RadioAutoTune] Inventory manager / invoker not found");
+
+		rec.m_AffiliationComp = rec.FindAffiliationComp();
+		if (rec.m_AffiliationComp)
+		{
+			rec.m_AffiliationComp.GetOnFactionChanged().Insert(OnFactionChanged);
+			m_OwnerByAffiliation.Insert(rec.m_AffiliationComp, rec);
+		}
+
+		rec.CollectRadios();
+
+		// Single attempt; if the faction is not known yet the faction/spawn
+		// events will enqueue the radios once it is.
+		MarkOwnerDirty(rec);
+	}
+
+	protected void UnhookOwner(CAV_RadioTuningOwner rec)
+	{
+		if (!rec.m_Hooked) return;
+		rec.m_Hooked = false;
+
+		if (rec.m_InvMgr)
+		{
+			rec.m_InvMgr.m_OnItemAddedInvoker.Remove(OnItemAdded);
+			rec.m_InvMgr.m_OnItemRemovedInvoker.Remove(OnItemRemoved);
+		}
+
+		if (rec.m_AffiliationComp)
+		{
+			rec.m_AffiliationComp.GetOnFactionChanged().Remove(OnFactionChanged);
+			m_OwnerByAffiliation.Remove(rec.m_AffiliationComp);
+		}
+	}
+
+	// --- Event handlers ------------------------------------------------------
+	protected void OnFactionChanged(FactionAffiliationComponent owner, Faction previousFaction, Faction newFaction)
+	{
+		if (!newFaction) return;
+
+		CAV_RadioTuningOwner rec = m_OwnerByAffiliation.Get(owner);
+		if (!rec) return;
+
+		if (rec.IsDebug()) PrintFormat("[CAV_RadioAutoTune] OnFactionChanged %1 -> %2", previousFaction, newFaction);
+		MarkOwnerDirty(rec);
+	}
+
+	protected void OnGroupPlayerAdded(SCR_AIGroup group, int playerId)
+	{
+		CAV_RadioTuningOwner rec = FindOwnerByPlayer(playerId);
+		if (!rec) return;
+
+		if (rec.IsDebug()) PrintFormat("[CAV_RadioAutoTune] Joined group=%1 player=%2", group, playerId);
+		SetOwnerGroup(rec, group);
+		MarkOwnerDirty(rec);
+	}
+
+	protected void OnGroupPlayerRemoved(SCR_AIGroup group, int playerId)
+	{
+		CAV_RadioTuningOwner rec = FindOwnerByPlayer(playerId);
+		if (!rec) return;
+
+		if (rec.IsDebug()) PrintFormat("[CAV_RadioAutoTune] Left group=%1 player=%2", group, playerId);
+		if (rec.m_Group == group)
+			SetOwnerGroup(rec, null);
+		MarkOwnerDirty(rec);
+	}
+
+	// O(radios in group): no context rebuild, no inventory scan, no queue
+	protected void OnGroupFrequencyChanged(SCR_AIGroup group, int frequency)
+	{
+		array<CAV_RadioTuningOwner> members = m_OwnersByGroup.Get(group);
+		if (!members || frequency <= 0) return;
+
+		foreach (CAV_RadioTuningOwner rec : members)
+		{
+			if (!rec) continue;
+
+			// No cached context yet: the pending retune will read the new frequency
+			CAV_RadioTuningContext ctx = rec.PeekContext();
+			if (!ctx || ctx.m_Group != group) continue;
+
+			ctx.SetGroupFrequency(frequency);
+			rec.RetuneGroupChannel(ctx);
+			CAV_Perf.Count("radio.group_pushes", rec.m_Radios.Count());
+		}
+	}
+
+	protected void OnPlayerSpawned(int playerId, IEntity controlledEntity)
+	{
+		CAV_RadioTuningOwner rec = m_OwnerByEntity.Get(controlledEntity);
+		if (!rec) return;
+
+		if (rec.IsDebug()) PrintFormat("[CAV_RadioAutoTune] Player %1 took control of owner", playerId);
+		MarkOwnerDirty(rec);
+	}
+
+	protected void OnItemAdded(IEntity item, BaseInventoryStorageComponent storage)
+	{
+		if (!item || !storage) return;
+
+		BaseRadioComponent radio = BaseRadioComponent.Cast(item.FindComponent(BaseRadioComponent));
+		if (!radio) return;
+
+		CAV_RadioTuningOwner rec = FindOwnerByStorage(storage);
+		if (!rec) return;
+
+		if (rec.IsDebug()) PrintFormat("[CAV_RadioAutoTune] OnItemAdded item=%1 storage=%2", item, storage);
+
+		if (rec.m_Radios.Find(radio) == -1)
+			rec.m_Radios.Insert(radio);
+
+		Enqueue(radio, rec);
+	}
+
+	protected void OnItemRemoved(IEntity item, BaseInventoryStorageComponent storage)
+	{
+		if (!item || !storage) return;
+
+		BaseRadioComponent radio = BaseRadioComponent.Cast(item.FindComponent(BaseRadioComponent));
+		if (!radio) return;
+
+		CAV_RadioTuningOwner rec = FindOwnerByStorage(storage);
+		if (rec)
+			rec.m_Radios.RemoveItem(radio);
+	}
+
+	// --- Lookup --------------------------------------------------------------
+	protected CAV_RadioTuningOwner FindOwnerByPlayer(int playerId)
+	{
+		if (playerId == 0) return null;
+
+		PlayerManager pm = GetGame().GetPlayerManager();
+		if (!pm) return null;
+
+		return m_OwnerByEntity.Get(pm.GetPlayerControlledEntity(playerId));
+	}
+
+	protected CAV_RadioTuningOwner FindOwnerByStorage(BaseInventoryStorageComponent storage)
+	{
+		IEntity ent = storage.GetOwner();
+		if (!ent) return null;
+
+		CAV_RadioTuningOwner rec = m_OwnerByEntity.Get(ent);
+		if (rec) return rec;
+
+		return m_OwnerByEntity.Get(ent.GetRootParent());
+	}
+
+	// --- Group index ---------------------------------------------------------
+	protected void SetOwnerGroup(CAV_RadioTuningOwner rec, SCR_AIGroup group)
+	{
+		if (rec.m_Group == group) return;
+
+		if (rec.m_Group)
+		{
+			array<CAV_RadioTuningOwner> oldMembers = m_OwnersByGroup.Get(rec.m_Group);
+			if (oldMembers)
+			{
+				oldMembers.RemoveItem(rec);
+				if (oldMembers.IsEmpty())
+					m_OwnersByGroup.Remove(rec.m_Group);
+			}
+		}
+
+		rec.m_Group = group;
+		if (!group) return;
+
+		array<CAV_RadioTuningOwner> members = m_OwnersByGroup.Get(group);
+		if (!members)
+		{
+			members = {};
+			m_OwnersByGroup.Insert(group, members);
+		}
+		members.Insert(rec);
+	}
+
+	// --- Dirty queue ---------------------------------------------------------
+	protected void MarkOwnerDirty(CAV_RadioTuningOwner rec)
+	{
+		CAV_Perf.Count("radio.context_invalidations");
+		rec.InvalidateContext();
+
+		// Not hooked yet: hookup will collect and enqueue its radios
+		if (!rec.m_Hooked) return;
+
+		foreach (BaseRadioComponent radio : rec.m_Radios)
+		{
+			Enqueue(radio, rec);
+		}
+	}
+
+	protected void Enqueue(BaseRadioComponent radio, CAV_RadioTuningOwner rec)
+	{
+		if (!radio || m_Queued.Contains(radio)) return;
+
+		m_Queued.Insert(radio);
+		m_QueueRadios.Insert(radio);
+		m_QueueOwners.Insert(rec);
+		Enable(true);
+	}
+
+	protected void ClearQueue()
+	{
+		m_QueueRadios.Clear();
+		m_QueueOwners.Clear();
+		m_Queued.Clear();
+		m_QueueHead = 0;
+	}
+
+	// --- Frame update --------------------------------------------------------
+	override protected void OnUpdate(ESystemPoint point)
+	{
+		CAV_PerfScope perfScope = CAV_Perf.Scope("radio.frame_ms");
+		int startMs = System.GetTickCount();
+
+		int hookups = Math.Min(m_PendingHookup.Count(), m_MaxHookupsPerFrame);
+		for (int i = 0; i < hookups; i++)
+		{
+			CAV_RadioTuningOwner pending = m_PendingHookup[i];
+			if (pending)
+				HookOwner(pending);
+		}
+		if (hookups > 0)
+			m_PendingHookup.RemoveOrdered(0, hookups);
+
+		// Game mode may have appeared since the first registrations
+		if (!m_GameMode)
+			HookGlobalEvents();
+
+		int done = 0;
+		int queued = m_QueueRadios.Count();
+		while (m_QueueHead < queued && done < m_MaxRadiosPerFrame)
+		{
+			BaseRadioComponent radio = m_QueueRadios[m_QueueHead];
+			CAV_RadioTuningOwner rec = m_QueueOwners[m_QueueHead];
+			m_QueueHead++;
+
+			if (!radio) continue;
+			m_Queued.RemoveItem(radio);
+
+			// Owner gone, or faction still unknown (its faction event re-enqueues)
+			if (!rec) continue;
+			CAV_RadioTuningContext ctx = rec.GetContext();
+			if (!ctx)
+			{
+				CAV_Perf.Count("radio.faction_unresolved");
+				continue;
+			}
+
+			// Owners that were already grouped before registering get indexed here
+			if (ctx.m_Group && ctx.m_Group != rec.m_Group)
+				SetOwnerGroup(rec, ctx.m_Group);
+
+			rec.RetuneRadio(radio, ctx);
+			done++;
+
+			if (System.GetTickCount() - startMs >= m_MaxFrameTimeMs)
+				break;
+		}
+
+		CAV_Perf.Count("radio.retunes", done);
+		CAV_Perf.Sample("radio.hookups", hookups);
+		if (CAV_Perf.s_Enabled) CAV_Perf.Sample("radio.queue_backlog", queued - m_QueueHead);
+
+		if (m_QueueHead >= queued)
+			ClearQueue();
+
+		if (m_QueueHead == 0 && m_QueueRadios.IsEmpty() && m_PendingHookup.IsEmpty())
+			Enable(false);
+	}
+}
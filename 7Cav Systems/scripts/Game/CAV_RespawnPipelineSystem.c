@@ -0,0 +1,637 @@
+// -----------------------------------------------------------------------------
+// CAV_RespawnPipelineSystem.c
+// - Admission: spawn requests draw from a token bucket (m_SpawnsPerSecond,
+//   m_BurstSize). Players over budget get a FIFO ticket and are told when it's
+//   their turn instead of all hitting the server in the same frame
+// - An admitted request only holds its token until the player actually spawns;
+//   a request that fails later in vanilla's checks or the spawn itself gets it
+//   back after m_TicketTimeoutS, and a retry in the meantime reuses it
+// - Load balancing: a spawn landing on a point that is already busy is moved to
+//   the least-used point of the same faction within m_BalanceRadius
+// - Pre-warming: the most requested loadout prefabs keep a few parked, inert
+//   characters ready; spawning one is a move + wake instead of a prefab build.
+//   The pool is only refilled while no burst is queued, and loadouts that drop
+//   out of the top set have their parked characters deleted
+// - Tickets are dropped when their player disconnects, spawns some other way
+//   or closes the deploy menu, so nobody burns a slot they can't use
+// -----------------------------------------------------------------------------
+
+class CAV_RespawnPipelineSystem : GameSystem
+{
+	[Attribute(defvalue: "1", uiwidget: UIWidgets.CheckBox, desc: "Queue, balance and pre-warm player spawns")]
+	protected bool m_Active;
+
+	[Attribute(defvalue: "4", uiwidget: UIWidgets.EditBox, desc: "Sustained spawns per second", params: "0.5 60 0.5")]
+	protected float m_SpawnsPerSecond;
+
+	[Attribute(defvalue: "6", uiwidget: UIWidgets.EditBox, desc: "Spawns allowed back-to-back before queueing starts", params: "1 64 1")]
+	protected int m_BurstSize;
+
+	[Attribute(defvalue: "15", uiwidget: UIWidgets.EditBox, desc: "Seconds a called-up ticket stays valid before it is skipped", params: "2 120 1")]
+	protected float m_TicketTimeoutS;
+
+	[Attribute(defvalue: "150", uiwidget: UIWidgets.EditBox, desc: "Spawn points of the same faction within this range share load (m)", params: "0 2000 10")]
+	protected float m_BalanceRadius;
+
+	[Attribute(defvalue: "10", uiwidget: UIWidgets.EditBox, desc: "Window for counting recent spawns per point (s)", params: "1 120 1")]
+	protected float m_BalanceWindowS;
+
+	[Attribute(defvalue: "3", uiwidget: UIWidgets.EditBox, desc: "Recent spawns at one point before others nearby take over", params: "1 64 1")]
+	protected int m_BalanceThreshold;
+
+	[Attribute(defvalue: "3", uiwidget: UIWidgets.EditBox, desc: "Loadout prefabs kept pre-warmed (most requested first). 0 = off", params: "0 16 1")]
+	protected int m_PrewarmLoadouts;
+
+	[Attribute(defvalue: "2", uiwidget: UIWidgets.EditBox, desc: "Parked characters per pre-warmed loadout", params: "0 16 1")]
+	protected int m_PoolSizePerLoadout;
+
+	[Attribute(defvalue: "2", uiwidget: UIWidgets.EditBox, desc: "Seconds between pool refills (one character each)", params: "0.1 60 0.1")]
+	protected float m_PrewarmIntervalS;
+
+	[Attribute(defvalue: "0 -200 0", uiwidget: UIWidgets.Coords, desc: "Where parked characters wait (kept inert and hidden)")]
+	protected vector m_ParkingPosition;
+
+	// --- Admission -----------------------------------------------------------
+	protected float m_Tokens;
+	protected ref array<int> m_Queue = {};           // player ids, FIFO
+	protected ref array<int> m_CalledUp = {};        // ticket holders allowed through
+	protected ref array<float> m_CalledUpAtS = {};
+	protected ref array<int> m_Reserved = {};        // admitted, token held until they spawn
+	protected ref array<float> m_ReservedAtS = {};
+
+	// --- Balancing -----------------------------------------------------------
+	protected ref map<SCR_SpawnPoint, ref array<float>> m_RecentBySpawnPoint = new map<SCR_SpawnPoint, ref array<float>>();
+
+	// --- Pool ----------------------------------------------------------------
+	protected ref map<string, ref array<IEntity>> m_Pool = new map<string, ref array<IEntity>>();
+	protected ref map<string, float> m_Popularity = new map<string, float>();
+	protected ref map<IEntity, bool> m_AIActiveBeforeParking = new map<IEntity, bool>();
+	protected float m_NextPrewarmS;
+
+	protected SCR_BaseGameMode m_GameMode;
+
+	protected float m_LastUpdateS;
+
+	//------------------------------------------------------------------------------------------------
+	override static void InitInfo(WorldSystemInfo outInfo)
+	{
+		outInfo
+			.SetAbstract(false)
+			.SetLocation(ESystemLocation.Server)
+			.AddPoint(ESystemPoint.Frame);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	static CAV_RespawnPipelineSystem GetInstance()
+	{
+		World world = GetGame().GetWorld();
+		if (!world) return null;
+		return CAV_RespawnPipelineSystem.Cast(world.FindSystem(CAV_RespawnPipelineSystem));
+	}
+
+	//------------------------------------------------------------------------------------------------
+	override protected void OnInit()
+	{
+		m_Tokens = m_BurstSize;
+		Enable(m_Active);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	override protected void OnCleanup()
+	{
+		if (m_GameMode)
+		{
+			m_GameMode.GetOnPlayerDisconnected().Remove(OnPlayerDisconnected);
+			m_GameMode.GetOnPlayerSpawned().Remove(OnPlayerSpawned);
+			m_GameMode = null;
+		}
+
+		foreach (string prefab, array<IEntity> parked : m_Pool)
+		{
+			foreach (IEntity ent : parked)
+			{
+				if (ent)
+					SCR_EntityHelper.DeleteEntityAndChildren(ent);
+			}
+		}
+		m_Pool.Clear();
+		m_AIActiveBeforeParking.Clear();
+	}
+
+	bool IsActive()
+	{
+		return m_Active;
+	}
+
+	// =================================================================================================
+	// ADMISSION
+	// =================================================================================================
+
+	// True if the player may spawn now. Otherwise they hold a ticket and get
+	// CAV_NotifySpawnTurn on their controller when it comes up.
+	bool TryAdmit(int playerId)
+	{
+		// Retry of a request that failed after admission: the token is still held
+		if (m_Reserved.Contains(playerId))
+			return true;
+
+		// Called-up ticket holders already paid their token
+		int called = m_CalledUp.Find(playerId);
+		if (called != -1)
+		{
+			m_CalledUp.Remove(called);
+			m_CalledUpAtS.Remove(called);
+			Reserve(playerId);
+			CAV_Perf.Count("respawn.admitted_ticket");
+			return true;
+		}
+
+		// Nobody waiting and budget left: straight through
+		if (m_Queue.IsEmpty() && m_Tokens >= 1)
+		{
+			m_Tokens -= 1;
+			Reserve(playerId);
+			CAV_Perf.Count("respawn.admitted");
+			return true;
+		}
+
+		if (!m_Queue.Contains(playerId))
+			m_Queue.Insert(playerId);
+
+		NotifyQueued(playerId, m_Queue.Find(playerId) + 1);
+		CAV_Perf.Count("respawn.queued");
+		return false;
+	}
+
+	// Leave the queue or give back a called-up slot
+	void CancelTicket(int playerId)
+	{
+		m_Queue.RemoveItem(playerId);
+		int called = m_CalledUp.Find(playerId);
+		if (called != -1)
+		{
+			m_CalledUp.Remove(called);
+			m_CalledUpAtS.Remove(called);
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected void Reserve(int playerId)
+	{
+		m_Reserved.Insert(playerId);
+		m_ReservedAtS.Insert(GetNowS());
+	}
+
+	// The spawn went through; the held token is spent
+	protected void CommitReservation(int playerId)
+	{
+		int reserved = m_Reserved.Find(playerId);
+		if (reserved == -1) return;
+
+		m_Reserved.Remove(reserved);
+		m_ReservedAtS.Remove(reserved);
+	}
+
+	// The admitted request never turned into a spawn
+	protected void RefundReservation(int playerId)
+	{
+		int reserved = m_Reserved.Find(playerId);
+		if (reserved == -1) return;
+
+		m_Reserved.Remove(reserved);
+		m_ReservedAtS.Remove(reserved);
+		m_Tokens = Math.Min(m_Tokens + 1, m_BurstSize);
+		CAV_Perf.Count("respawn.refunded");
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected void DrainQueue(float nowS)
+	{
+		// Expire tickets nobody used
+		for (int i = m_CalledUp.Count() - 1; i >= 0; i--)
+		{
+			if (nowS - m_CalledUpAtS[i] < m_TicketTimeoutS) continue;
+			m_CalledUp.Remove(i);
+			m_CalledUpAtS.Remove(i);
+			CAV_Perf.Count("respawn.ticket_expired");
+		}
+
+		// Admitted requests that failed after the check and were not retried
+		for (int i = m_Reserved.Count() - 1; i >= 0; i--)
+		{
+			if (nowS - m_ReservedAtS[i] < m_TicketTimeoutS) continue;
+			RefundReservation(m_Reserved[i]);
+		}
+
+		while (!m_Queue.IsEmpty() && m_Tokens >= 1)
+		{
+			int playerId = m_Queue[0];
+			m_Queue.RemoveOrdered(0);
+
+			SCR_PlayerController pc = SCR_PlayerController.Cast(GetGame().GetPlayerManager().GetPlayerController(playerId));
+			if (!pc) continue;
+
+			m_Tokens -= 1;
+			m_CalledUp.Insert(playerId);
+			m_CalledUpAtS.Insert(nowS);
+			pc.CAV_NotifySpawnTurn();
+		}
+
+		CAV_Perf.Sample("respawn.queue_len", m_Queue.Count());
+	}
+
+	// Game mode may not exist yet when the system initializes
+	protected void HookGameMode()
+	{
+		m_GameMode = SCR_BaseGameMode.Cast(GetGame().GetGameMode());
+		if (!m_GameMode) return;
+
+		m_GameMode.GetOnPlayerDisconnected().Insert(OnPlayerDisconnected);
+		m_GameMode.GetOnPlayerSpawned().Insert(OnPlayerSpawned);
+	}
+
+	protected void OnPlayerDisconnected(int playerId, KickCauseCode cause, int timeout)
+	{
+		CancelTicket(playerId);
+		RefundReservation(playerId);
+	}
+
+	// Also covers spawning through another path (GM, scenario) while still queued
+	protected void OnPlayerSpawned(int playerId, IEntity controlledEntity)
+	{
+		CommitReservation(playerId);
+		CancelTicket(playerId);
+	}
+
+	protected void NotifyQueued(int playerId, int position)
+	{
+		SCR_PlayerController pc = SCR_PlayerController.Cast(GetGame().GetPlayerManager().GetPlayerController(playerId));
+		if (pc)
+			pc.CAV_NotifySpawnQueued(position);
+	}
+
+	// =================================================================================================
+	// LOAD BALANCING
+	// =================================================================================================
+
+	// Position/angles of a less busy point nearby, or the input unchanged
+	void Balance(inout vector position, inout vector angles)
+	{
+		float nowS = GetNowS();
+		SCR_SpawnPoint origin = FindSpawnPointAt(position);
+		if (!origin)
+			return;
+
+		int originLoad = GetRecentCount(origin, nowS);
+		SCR_SpawnPoint target = origin;
+
+		if (originLoad >= m_BalanceThreshold && m_BalanceRadius > 0)
+		{
+			string faction = origin.GetFactionKey();
+			float radiusSq = m_BalanceRadius * m_BalanceRadius;
+			int bestLoad = originLoad;
+
+			foreach (SCR_SpawnPoint sp : SCR_SpawnPoint.GetSpawnPoints())
+			{
+				if (!sp || sp == origin || sp.GetFactionKey() != faction) continue;
+				if (vector.DistanceSqXZ(sp.GetOrigin(), origin.GetOrigin()) > radiusSq) continue;
+
+				int load = GetRecentCount(sp, nowS);
+				if (load < bestLoad)
+				{
+					bestLoad = load;
+					target = sp;
+				}
+			}
+		}
+
+		if (target != origin)
+		{
+			target.GetPositionAndRotation(position, angles);
+			CAV_Perf.Count("respawn.rebalanced");
+		}
+
+		array<float> recent = m_RecentBySpawnPoint.Get(target);
+		if (!recent)
+		{
+			recent = {};
+			m_RecentBySpawnPoint.Insert(target, recent);
+		}
+		recent.Insert(nowS);
+	}
+
+	protected int GetRecentCount(SCR_SpawnPoint sp, float nowS)
+	{
+		array<float> recent = m_RecentBySpawnPoint.Get(sp);
+		if (!recent) return 0;
+
+		while (!recent.IsEmpty() && nowS - recent[0] > m_BalanceWindowS)
+		{
+			recent.RemoveOrdered(0);
+		}
+		return recent.Count();
+	}
+
+	// Spawn point whose area the spawn position lies in
+	protected SCR_SpawnPoint FindSpawnPointAt(vector position)
+	{
+		SCR_SpawnPoint best;
+		float bestSq = 50 * 50;
+		foreach (SCR_SpawnPoint sp : SCR_SpawnPoint.GetSpawnPoints())
+		{
+			if (!sp) continue;
+			float d = vector.DistanceSqXZ(sp.GetOrigin(), position);
+			if (d < bestSq)
+			{
+				bestSq = d;
+				best = sp;
+			}
+		}
+		return best;
+	}
+
+	// =================================================================================================
+	// PRE-WARMED POOL
+	// =================================================================================================
+
+	// A parked character of the prefab moved to the spawn, or null
+	IEntity TakePrewarmed(string prefab, vector position, vector angles)
+	{
+		m_Popularity.Set(prefab, m_Popularity.Get(prefab) + 1);
+
+		array<IEntity> parked = m_Pool.Get(prefab);
+		while (parked && !parked.IsEmpty())
+		{
+			IEntity ent = parked[parked.Count() - 1];
+			parked.Remove(parked.Count() - 1);
+			if (!ent) continue;
+
+			vector transform[4];
+			Math3D.AnglesToMatrix(angles, transform);
+			transform[3] = position;
+
+			// Replicated: a plain transform set would leave clients with the parked position
+			BaseGameEntity gameEntity = BaseGameEntity.Cast(ent);
+			if (gameEntity)
+				gameEntity.Teleport(transform);
+			else
+				ent.SetWorldTransform(transform);
+			SetParked(ent, false);
+
+			CAV_Perf.Count("respawn.pool_hit");
+			return ent;
+		}
+
+		CAV_Perf.Count("respawn.pool_miss");
+		return null;
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected void Prewarm()
+	{
+		if (m_PrewarmLoadouts <= 0 || m_PoolSizePerLoadout <= 0) return;
+
+		// Most requested prefabs first; popularity decays so the set follows the mission
+		array<string> prefabs = {};
+		array<float> scores = {};
+		foreach (string prefab, float score : m_Popularity)
+		{
+			int at = 0;
+			while (at < scores.Count() && scores[at] >= score)
+			{
+				at++;
+			}
+			prefabs.InsertAt(prefab, at);
+			scores.InsertAt(score, at);
+			m_Popularity.Set(prefab, score * 0.9);
+		}
+
+		int count = Math.Min(prefabs.Count(), m_PrewarmLoadouts);
+		TrimPools(prefabs, count);
+
+		for (int i = 0; i < count; i++)
+		{
+			array<IEntity> parked = m_Pool.Get(prefabs[i]);
+			if (!parked)
+			{
+				parked = {};
+				m_Pool.Insert(prefabs[i], parked);
+			}
+
+			if (parked.Count() >= m_PoolSizePerLoadout) continue;
+
+			IEntity ent = SpawnParked(prefabs[i]);
+			if (ent)
+			{
+				parked.Insert(ent);
+				CAV_Perf.Count("respawn.prewarmed");
+			}
+			return; // one per refill tick
+		}
+	}
+
+	// Delete parked characters of loadouts that fell out of the top set
+	protected void TrimPools(array<string> ranked, int count)
+	{
+		array<string> stale = {};
+		foreach (string prefab, array<IEntity> parked : m_Pool)
+		{
+			int rank = ranked.Find(prefab);
+			if (rank == -1 || rank >= count)
+				stale.Insert(prefab);
+		}
+
+		foreach (string prefab : stale)
+		{
+			foreach (IEntity ent : m_Pool.Get(prefab))
+			{
+				if (!ent) continue;
+				m_AIActiveBeforeParking.Remove(ent);
+				SCR_EntityHelper.DeleteEntityAndChildren(ent);
+				CAV_Perf.Count("respawn.pool_trimmed");
+			}
+			m_Pool.Remove(prefab);
+		}
+	}
+
+	protected IEntity SpawnParked(string prefab)
+	{
+		Resource res = Resource.Load(prefab);
+		if (!res || !res.IsValid()) return null;
+
+		EntitySpawnParams params = new EntitySpawnParams();
+		params.TransformMode = ETransformMode.WORLD;
+		params.Transform[3] = m_ParkingPosition;
+
+		IEntity ent = GetGame().SpawnEntityPrefab(res, GetWorld(), params);
+		if (ent)
+			SetParked(ent, true);
+		return ent;
+	}
+
+	protected void SetParked(IEntity ent, bool parked)
+	{
+		if (parked)
+			ent.ClearFlags(EntityFlags.VISIBLE | EntityFlags.ACTIVE);
+		else
+			ent.SetFlags(EntityFlags.VISIBLE | EntityFlags.ACTIVE);
+
+		Physics physics = ent.GetPhysics();
+		if (physics)
+			physics.SetActive(!parked);
+
+		// Parked characters must not think or be seen by AI; on wake the prefab's
+		// own AI state comes back (off for player characters)
+		AIControlComponent aiControl = AIControlComponent.Cast(ent.FindComponent(AIControlComponent));
+		if (!aiControl)
+			return;
+
+		if (parked)
+		{
+			m_AIActiveBeforeParking.Set(ent, aiControl.IsAIActivated());
+			aiControl.DeactivateAI();
+			return;
+		}
+
+		bool wasActive;
+		if (m_AIActiveBeforeParking.Find(ent, wasActive))
+		{
+			m_AIActiveBeforeParking.Remove(ent);
+			if (wasActive)
+				aiControl.ActivateAI();
+		}
+	}
+
+	// =================================================================================================
+	// FRAME
+	// =================================================================================================
+
+	override protected void OnUpdate(ESystemPoint point)
+	{
+		if (!m_GameMode)
+			HookGameMode();
+
+		float nowS = GetNowS();
+		float dt = nowS - m_LastUpdateS;
+		m_LastUpdateS = nowS;
+
+		m_Tokens = Math.Min(m_Tokens + dt * m_SpawnsPerSecond, m_BurstSize);
+		DrainQueue(nowS);
+
+		// Only build pool characters in quiet periods
+		if (m_Queue.IsEmpty() && m_CalledUp.IsEmpty() && nowS >= m_NextPrewarmS)
+		{
+			m_NextPrewarmS = nowS + m_PrewarmIntervalS;
+			CAV_PerfScope perfScope = CAV_Perf.Scope("respawn.prewarm_ms");
+			Prewarm();
+		}
+	}
+
+	protected float GetNowS()
+	{
+		return GetWorld().GetWorldTime() * 0.001;
+	}
+}
+
+// ---- Server-side hooks into the respawn handler
+modded class SCR_SpawnHandlerComponent
+{
+	override bool CanRequestSpawn_S(SCR_SpawnRequestComponent requestComponent, SCR_SpawnData data, out SCR_ESpawnResult result = SCR_ESpawnResult.SPAWN_NOT_ALLOWED)
+	{
+		if (!super.CanRequestSpawn_S(requestComponent, data, result))
+			return false;
+
+		CAV_RespawnPipelineSystem pipeline = CAV_RespawnPipelineSystem.GetInstance();
+		if (!pipeline || !pipeline.IsActive())
+			return true;
+
+		if (pipeline.TryAdmit(requestComponent.GetPlayerId()))
+			return true;
+
+		result = SCR_ESpawnResult.SPAWN_NOT_ALLOWED;
+		return false;
+	}
+
+	override protected IEntity DoSpawn_S(string prefab, vector position, vector angles)
+	{
+		CAV_RespawnPipelineSystem pipeline = CAV_RespawnPipelineSystem.GetInstance();
+		if (!pipeline || !pipeline.IsActive())
+			return super.DoSpawn_S(prefab, position, angles);
+
+		CAV_PerfScope perfScope = CAV_Perf.Scope("respawn.spawn_ms");
+
+		pipeline.Balance(position, angles);
+
+		IEntity ent = pipeline.TakePrewarmed(prefab, position, angles);
+		if (ent)
+			return ent;
+
+		return super.DoSpawn_S(prefab, position, angles);
+	}
+}
+
+// ---- Queue notices for the waiting player
+modded class SCR_PlayerController
+{
+	protected ref ScriptInvoker m_CAV_OnSpawnTurn;
+
+	// Invoked on the owning client when a queued spawn may be retried
+	ScriptInvoker CAV_GetOnSpawnTurn()
+	{
+		if (!m_CAV_OnSpawnTurn)
+			m_CAV_OnSpawnTurn = new ScriptInvoker();
+		return m_CAV_OnSpawnTurn;
+	}
+
+	// Client: stop waiting for a deployment slot
+	void CAV_CancelSpawnTicket()
+	{
+		Rpc(CAV_RpcAsk_CancelSpawnTicket);
+	}
+
+	[RplRpc(RplChannel.Reliable, RplRcver.Server)]
+	protected void CAV_RpcAsk_CancelSpawnTicket()
+	{
+		CAV_RespawnPipelineSystem pipeline = CAV_RespawnPipelineSystem.GetInstance();
+		if (pipeline)
+			pipeline.CancelTicket(GetPlayerId());
+	}
+
+	void CAV_NotifySpawnQueued(int position)
+	{
+		Rpc(CAV_RpcDo_SpawnQueued, position);
+	}
+
+	void CAV_NotifySpawnTurn()
+	{
+		Rpc(CAV_RpcDo_SpawnTurn);
+	}
+
+	[RplRpc(RplChannel.Reliable, RplRcver.Owner)]
+	protected void CAV_RpcDo_SpawnQueued(int position)
+	{
+		SCR_HintManagerComponent.ShowCustomHint(string.Format("Deployment is busy. You are number %1 in the queue.", position), "Deploy queue", 5);
+	}
+
+	[RplRpc(RplChannel.Reliable, RplRcver.Owner)]
+	protected void CAV_RpcDo_SpawnTurn()
+	{
+		SCR_HintManagerComponent.ShowCustomHint("Your deployment slot is ready. Deploy now.", "Deploy queue", 5);
+
+		if (m_CAV_OnSpawnTurn)
+			m_CAV_OnSpawnTurn.Invoke();
+	}
+}
+
+// ---- Leaving the deploy menu gives the queued slot back
+modded class SCR_DeployMenuMain
+{
+	override void OnMenuClose()
+	{
+		super.OnMenuClose();
+
+		SCR_PlayerController pc = SCR_PlayerController.Cast(GetGame().GetPlayerController());
+		if (pc)
+			pc.CAV_CancelSpawnTicket();
+	}
+}
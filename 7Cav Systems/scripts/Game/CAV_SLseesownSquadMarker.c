@@ -1,16 +1,262 @@
+// -----------------------------------------------------------------------------
+// CAV_SLseesownSquadMarker.c
+// - Squad leader markers are visible to everyone, own squad included
+// - CAV_SquadMarkerManager (client) owns every squad leader marker:
+//   - visibility is only recomputed on player-id, group or leader changes and
+//     only written when it actually flips
+//   - while the map is open, marker position refresh is throttled by zoom
+//     (every frame zoomed in, m_ZoomedOutRefreshS zoomed out)
+//   - zoomed out, markers closer than m_ClusterPx on screen collapse to one
+// - Nothing runs while the map is closed
+// -----------------------------------------------------------------------------
+
+class CAV_SquadMarkerManager : GameSystem
+{
+	[Attribute(defvalue: "0.5", uiwidget: UIWidgets.EditBox, desc: "Marker position refresh interval when fully zoomed out (s)", params: "0 5 0.05")]
+	protected float m_ZoomedOutRefreshS;
+
+	[Attribute(defvalue: "2", uiwidget: UIWidgets.EditBox, desc: "Map zoom (px per m) at or above which positions refresh every frame and nothing clusters", params: "0.01 20 0.01")]
+	protected float m_DetailZoom;
+
+	[Attribute(defvalue: "24", uiwidget: UIWidgets.EditBox, desc: "Markers closer than this on screen are clustered (px)", params: "0 200 1")]
+	protected int m_ClusterPx;
+
+	[Attribute(defvalue: "0.25", uiwidget: UIWidgets.EditBox, desc: "Seconds between re-clustering while the map is open", params: "0.05 5 0.05")]
+	protected float m_ClusterIntervalS;
+
+	// --- State ---------------------------------------------------------------
+	protected ref array<SCR_MapMarkerSquadLeader> m_Markers = {};
+	protected float m_RefreshIntervalS;
+	protected float m_NextClusterS;
+	protected bool m_Clustering;
+
+	protected ref array<int> m_ScreenX = {};
+	protected ref array<int> m_ScreenY = {};
+
+	//------------------------------------------------------------------------------------------------
+	override static void InitInfo(WorldSystemInfo outInfo)
+	{
+		outInfo
+			.SetAbstract(false)
+			.SetLocation(ESystemLocation.Client)
+			.AddPoint(ESystemPoint.Frame);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	static CAV_SquadMarkerManager GetInstance()
+	{
+		World world = GetGame().GetWorld();
+		if (!world) return null;
+		return CAV_SquadMarkerManager.Cast(world.FindSystem(CAV_SquadMarkerManager));
+	}
+
+	//------------------------------------------------------------------------------------------------
+	override protected void OnInit()
+	{
+		SCR_MapEntity.GetOnMapOpen().Insert(OnMapOpen);
+		SCR_MapEntity.GetOnMapClose().Insert(OnMapClose);
+		SCR_AIGroup.GetOnPlayerLeaderChanged().Insert(OnLeaderChanged);
+
+		Enable(false);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	override protected void OnCleanup()
+	{
+		SCR_MapEntity.GetOnMapOpen().Remove(OnMapOpen);
+		SCR_MapEntity.GetOnMapClose().Remove(OnMapClose);
+		SCR_AIGroup.GetOnPlayerLeaderChanged().Remove(OnLeaderChanged);
+	}
+
+	// --- Registration --------------------------------------------------------
+	void Register(notnull SCR_MapMarkerSquadLeader marker)
+	{
+		if (!m_Markers.Contains(marker))
+			m_Markers.Insert(marker);
+
+		marker.CAV_RefreshVisibility();
+	}
+
+	// --- Events --------------------------------------------------------------
+	protected void OnLeaderChanged(int groupID, int playerID)
+	{
+		// A leader change reassigns which player a marker follows; re-evaluate them all once
+		foreach (SCR_MapMarkerSquadLeader marker : m_Markers)
+		{
+			if (marker)
+				marker.CAV_RefreshVisibility();
+		}
+		m_NextClusterS = 0;
+	}
+
+	protected void OnMapOpen(MapConfiguration config)
+	{
+		m_NextClusterS = 0;
+		Enable(true);
+	}
+
+	protected void OnMapClose(MapConfiguration config)
+	{
+		Enable(false);
+
+		// Leave no marker hidden by a stale cluster
+		foreach (SCR_MapMarkerSquadLeader marker : m_Markers)
+		{
+			if (marker)
+				marker.CAV_SetClustered(false);
+		}
+	}
+
+	// --- Throttling ----------------------------------------------------------
+	// How often a marker's position is refreshed at the current zoom
+	float GetRefreshInterval()
+	{
+		return m_RefreshIntervalS;
+	}
+
+	//------------------------------------------------------------------------------------------------
+	override protected void OnUpdate(ESystemPoint point)
+	{
+		SCR_MapEntity map = SCR_MapEntity.GetMapInstance();
+		if (!map || !map.IsOpen()) return;
+
+		// 0 at detail zoom or closer, up to m_ZoomedOutRefreshS fully zoomed out
+		float zoom = map.GetCurrentZoom();
+		float t = 1 - Math.Clamp((zoom - map.GetMinZoom()) / Math.Max(m_DetailZoom - map.GetMinZoom(), 0.001), 0, 1);
+		m_RefreshIntervalS = t * m_ZoomedOutRefreshS;
+		m_Clustering = zoom < m_DetailZoom && m_ClusterPx > 0;
+
+		float nowS = GetWorld().GetWorldTime() * 0.001;
+		if (nowS < m_NextClusterS) return;
+		m_NextClusterS = nowS + m_ClusterIntervalS;
+
+		CAV_PerfScope perfScope = CAV_Perf.Scope("slmarker.cluster_ms");
+		Cluster(map);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	// Greedy screen-space clustering: the first marker of a cluster stays, the rest hide
+	protected void Cluster(SCR_MapEntity map)
+	{
+		m_ScreenX.Clear();
+		m_ScreenY.Clear();
+
+		for (int i = m_Markers.Count() - 1; i >= 0; i--)
+		{
+			if (!m_Markers[i])
+				m_Markers.Remove(i);
+		}
+
+		int clusterSq = m_ClusterPx * m_ClusterPx;
+		int hidden = 0;
+		foreach (SCR_MapMarkerSquadLeader marker : m_Markers)
+		{
+			if (!m_Clustering || !marker.CAV_IsWanted())
+			{
+				marker.CAV_SetClustered(false);
+				continue;
+			}
+
+			vector pos = marker.GetOrigin();
+			int x, y;
+			map.WorldToScreen(pos[0], pos[2], x, y, true);
+
+			bool absorbed = false;
+			foreach (int c, int cx : m_ScreenX)
+			{
+				int dx = x - cx;
+				int dy = y - m_ScreenY[c];
+				if (dx * dx + dy * dy <= clusterSq)
+				{
+					absorbed = true;
+					break;
+				}
+			}
+
+			marker.CAV_SetClustered(absorbed);
+			if (absorbed)
+			{
+				hidden++;
+				continue;
+			}
+
+			m_ScreenX.Insert(x);
+			m_ScreenY.Insert(y);
+		}
+
+		CAV_Perf.Sample("slmarker.clustered", hidden);
+	}
+}
+
 modded class SCR_MapMarkerSquadLeader
 {
+	protected int m_CAV_LastPlayerId = -2;
+	protected bool m_CAV_Wanted;
+	protected bool m_CAV_Clustered;
+	protected bool m_CAV_Shown;
+	protected bool m_CAV_Applied;
+	protected float m_CAV_NextRefreshS;
+
 	override void OnPlayerIdUpdate()
 	{
-		PlayerController pController = GetGame().GetPlayerController();
-		if (!pController)
+		if (m_PlayerID == m_CAV_LastPlayerId)
 			return;
-		
-		if (m_PlayerID == pController.GetPlayerId())	// if this is us, dont display
-			SetLocalVisible(true); // set this true for markers testing
+
+		m_CAV_LastPlayerId = m_PlayerID;
+
+		CAV_SquadMarkerManager manager = CAV_SquadMarkerManager.GetInstance();
+		if (manager)
+			manager.Register(this);
 		else
+			CAV_RefreshVisibility();
+	}
+
+	// Position work only as often as the zoom level warrants
+	override void OnUpdate()
+	{
+		CAV_SquadMarkerManager manager = CAV_SquadMarkerManager.GetInstance();
+		if (manager && m_CAV_Applied)
 		{
-			SetLocalVisible(true);
+			float nowS = GetGame().GetWorld().GetWorldTime() * 0.001;
+			if (nowS < m_CAV_NextRefreshS)
+				return;
+			m_CAV_NextRefreshS = nowS + manager.GetRefreshInterval();
 		}
+
+		super.OnUpdate();
+	}
+
+	//------------------------------------------------------------------------------------------------
+	// Squad leader markers are shown to everyone, own squad included
+	void CAV_RefreshVisibility()
+	{
+		PlayerController pController = GetGame().GetPlayerController();
+		m_CAV_Wanted = pController != null;
+		CAV_Apply();
+	}
+
+	void CAV_SetClustered(bool clustered)
+	{
+		if (clustered == m_CAV_Clustered)
+			return;
+
+		m_CAV_Clustered = clustered;
+		CAV_Apply();
+	}
+
+	bool CAV_IsWanted()
+	{
+		return m_CAV_Wanted;
+	}
+
+	protected void CAV_Apply()
+	{
+		bool show = m_CAV_Wanted && !m_CAV_Clustered;
+		if (m_CAV_Applied && show == m_CAV_Shown)
+			return;
+
+		m_CAV_Shown = show;
+		m_CAV_Applied = true;
+		SetLocalVisible(show);
 	}
-}
\ No newline at end of file
+}
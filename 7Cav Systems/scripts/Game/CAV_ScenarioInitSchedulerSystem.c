@@ -0,0 +1,269 @@
+// -----------------------------------------------------------------------------
+// CAV_ScenarioInitSchedulerSystem.c
+// - Scenario Framework slots no longer spawn inside the Init() call that
+//   reaches them; they are queued here and released under a per-frame budget
+//   (m_MaxSlotsPerFrame, m_MaxFrameTimeMs)
+// - Order: hierarchy depth first (a slot never spawns before the slots of its
+//   enclosing layers), then distance to the nearest player, so what players
+//   can see comes up first
+// - Layers and actions are untouched; their own children-spawned bookkeeping
+//   already tolerates slots completing over several frames
+// - Slots initialized after the startup burst still go through the queue,
+//   which keeps ActionSpawnObjects bursts from landing in one frame
+// - The deferral check runs at the top of the most derived Init (SlotAI,
+//   SlotTask, base), before any subclass code, so post-super.Init work only
+//   runs once, on release, with the slot's entity actually spawned
+// -----------------------------------------------------------------------------
+
+class CAV_ScenarioInitRequest
+{
+	SCR_ScenarioFrameworkSlotBase m_Slot;
+	SCR_ScenarioFrameworkArea m_Area;
+	SCR_ScenarioFrameworkEActivationType m_Activation;
+	int m_Depth;
+	float m_DistanceSq;
+}
+
+class CAV_ScenarioInitSchedulerSystem : GameSystem
+{
+	[Attribute(defvalue: "1", uiwidget: UIWidgets.CheckBox, desc: "Stagger Scenario Framework slot spawning")]
+	protected bool m_Active;
+
+	[Attribute(defvalue: "6", uiwidget: UIWidgets.EditBox, desc: "Max slots released per frame", params: "1 128 1")]
+	protected int m_MaxSlotsPerFrame;
+
+	[Attribute(defvalue: "3", uiwidget: UIWidgets.EditBox, desc: "Max milliseconds of slot spawning per frame", params: "1 50 1")]
+	protected int m_MaxFrameTimeMs;
+
+	[Attribute(defvalue: "2", uiwidget: UIWidgets.EditBox, desc: "Seconds between refreshing queued slots' player distance", params: "0.25 30 0.25")]
+	protected float m_ResortIntervalS;
+
+	// --- State ---------------------------------------------------------------
+	protected ref array<ref CAV_ScenarioInitRequest> m_Pending = {};
+	protected ref set<SCR_ScenarioFrameworkSlotBase> m_Queued = new set<SCR_ScenarioFrameworkSlotBase>();
+	protected ref array<vector> m_PlayerPositions = {};
+	protected bool m_Dirty;
+	protected float m_NextResortS;
+
+	//------------------------------------------------------------------------------------------------
+	override static void InitInfo(WorldSystemInfo outInfo)
+	{
+		outInfo
+			.SetAbstract(false)
+			.SetLocation(ESystemLocation.Server)
+			.AddPoint(ESystemPoint.Frame);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	static CAV_ScenarioInitSchedulerSystem GetInstance()
+	{
+		World world = GetGame().GetWorld();
+		if (!world) return null;
+		return CAV_ScenarioInitSchedulerSystem.Cast(world.FindSystem(CAV_ScenarioInitSchedulerSystem));
+	}
+
+	//------------------------------------------------------------------------------------------------
+	override protected void OnInit()
+	{
+		Enable(false);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	bool IsActive()
+	{
+		return m_Active;
+	}
+
+	int GetPendingCount()
+	{
+		return m_Pending.Count();
+	}
+
+	// --- Intake --------------------------------------------------------------
+	// False if the slot is already waiting
+	bool Enqueue(notnull SCR_ScenarioFrameworkSlotBase slot, SCR_ScenarioFrameworkArea area, SCR_ScenarioFrameworkEActivationType activation)
+	{
+		if (m_Queued.Contains(slot)) return false;
+
+		CAV_ScenarioInitRequest req = new CAV_ScenarioInitRequest();
+		req.m_Slot = slot;
+		req.m_Area = area;
+		req.m_Activation = activation;
+		req.m_Depth = GetDepth(slot.GetOwner());
+		req.m_DistanceSq = GetDistanceSq(slot);
+
+		m_Pending.Insert(req);
+		m_Queued.Insert(slot);
+		m_Dirty = true;
+
+		CAV_Perf.Count("sfinit.queued");
+		Enable(true);
+		return true;
+	}
+
+	// --- Frame update --------------------------------------------------------
+	override protected void OnUpdate(ESystemPoint point)
+	{
+		CAV_PerfScope perfScope = CAV_Perf.Scope("sfinit.frame_ms");
+
+		if (m_Pending.IsEmpty())
+		{
+			Enable(false);
+			return;
+		}
+
+		float nowS = GetWorld().GetWorldTime() * 0.001;
+		if (nowS >= m_NextResortS)
+		{
+			m_NextResortS = nowS + m_ResortIntervalS;
+			RefreshDistances();
+			m_Dirty = true;
+		}
+
+		if (m_Dirty)
+		{
+			m_Dirty = false;
+			Sort();
+		}
+
+		int startMs = System.GetTickCount();
+		int done = 0;
+
+		// m_Pending is sorted best-last so release is a cheap pop
+		while (!m_Pending.IsEmpty() && done < m_MaxSlotsPerFrame)
+		{
+			int last = m_Pending.Count() - 1;
+			CAV_ScenarioInitRequest req = m_Pending[last];
+			m_Pending.Remove(last);
+
+			if (!req.m_Slot) continue;
+			m_Queued.RemoveItem(req.m_Slot);
+
+			req.m_Slot.CAV_ReleaseInit(req.m_Area, req.m_Activation);
+			done++;
+
+			if (System.GetTickCount() - startMs >= m_MaxFrameTimeMs)
+				break;
+		}
+
+		CAV_Perf.Count("sfinit.released", done);
+		CAV_Perf.Sample("sfinit.pending", m_Pending.Count());
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected void RefreshDistances()
+	{
+		CAV_SpatialGrid.GatherPlayerPositions(m_PlayerPositions);
+
+		foreach (CAV_ScenarioInitRequest req : m_Pending)
+		{
+			if (req.m_Slot)
+				req.m_DistanceSq = GetDistanceSq(req.m_Slot);
+		}
+	}
+
+	// Player positions are the ones from the last refresh; no players yet = all equal
+	protected float GetDistanceSq(SCR_ScenarioFrameworkSlotBase slot)
+	{
+		if (m_PlayerPositions.IsEmpty())
+			return 0;
+		return CAV_SpatialGrid.MinDistanceSq2D(slot.GetOwner().GetOrigin(), m_PlayerPositions);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected void Sort()
+	{
+		// Insertion sort; the queue is mostly sorted between passes
+		for (int i = 1; i < m_Pending.Count(); i++)
+		{
+			CAV_ScenarioInitRequest req = m_Pending[i];
+			int j = i - 1;
+			while (j >= 0 && Before(m_Pending[j], req))
+			{
+				m_Pending[j + 1] = m_Pending[j];
+				j--;
+			}
+			m_Pending[j + 1] = req;
+		}
+	}
+
+	// True if a should be released before b
+	protected static bool Before(CAV_ScenarioInitRequest a, CAV_ScenarioInitRequest b)
+	{
+		if (a.m_Depth != b.m_Depth)
+			return a.m_Depth < b.m_Depth;
+		return a.m_DistanceSq < b.m_DistanceSq;
+	}
+
+	protected static int GetDepth(IEntity ent)
+	{
+		int depth = 0;
+		IEntity parent = ent.GetParent();
+		while (parent)
+		{
+			depth++;
+			parent = parent.GetParent();
+		}
+		return depth;
+	}
+}
+
+// ---- Route slot initialization through the scheduler
+modded class SCR_ScenarioFrameworkSlotBase
+{
+	protected bool m_CAV_InitReleased;
+
+	override void Init(SCR_ScenarioFrameworkArea area = null, SCR_ScenarioFrameworkEActivationType activation = SCR_ScenarioFrameworkEActivationType.SAME_AS_PARENT)
+	{
+		if (CAV_DeferInit(area, activation))
+			return;
+
+		// Deepest override in the chain: every guard above has seen the release
+		m_CAV_InitReleased = false;
+		super.Init(area, activation);
+	}
+
+	// True if Init was queued and the caller must return before doing anything.
+	// Subclasses whose Init has work after super.Init call this first.
+	bool CAV_DeferInit(SCR_ScenarioFrameworkArea area, SCR_ScenarioFrameworkEActivationType activation)
+	{
+		if (m_CAV_InitReleased || !Replication.IsServer())
+			return false;
+
+		CAV_ScenarioInitSchedulerSystem scheduler = CAV_ScenarioInitSchedulerSystem.GetInstance();
+		if (!scheduler || !scheduler.IsActive())
+			return false;
+
+		scheduler.Enqueue(this, area, activation);
+		return true;
+	}
+
+	void CAV_ReleaseInit(SCR_ScenarioFrameworkArea area, SCR_ScenarioFrameworkEActivationType activation)
+	{
+		m_CAV_InitReleased = true;
+		Init(area, activation);
+	}
+}
+
+// ---- Subclasses that keep working after super.Init defer before it
+modded class SCR_ScenarioFrameworkSlotAI
+{
+	override void Init(SCR_ScenarioFrameworkArea area = null, SCR_ScenarioFrameworkEActivationType activation = SCR_ScenarioFrameworkEActivationType.SAME_AS_PARENT)
+	{
+		if (CAV_DeferInit(area, activation))
+			return;
+
+		super.Init(area, activation);
+	}
+}
+
+modded class SCR_ScenarioFrameworkSlotTask
+{
+	override void Init(SCR_ScenarioFrameworkArea area = null, SCR_ScenarioFrameworkEActivationType activation = SCR_ScenarioFrameworkEActivationType.SAME_AS_PARENT)
+	{
+		if (CAV_DeferInit(area, activation))
+			return;
+
+		super.Init(area, activation);
+	}
+}
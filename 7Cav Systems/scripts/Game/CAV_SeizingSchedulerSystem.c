@@ -0,0 +1,286 @@
+// -----------------------------------------------------------------------------
+// CAV_SeizingSchedulerSystem.c
+// - Every SCR_SeizingComponent registers here; its character trigger stops
+//   querying on its own and is driven by activity tier instead:
+//     IDLE    nobody within radius + m_WakeMargin   -> periodic queries off
+//     NEARBY  someone within the margin             -> m_NearbyRateS
+//     ACTIVE  someone inside the seizing radius     -> m_ActiveRateS
+// - Characters (players and AI agents) go into one CAV_SpatialGrid rebuilt
+//   every m_GridRebuildS; a base's tier check is a handful of cell lookups
+// - Idle bases are only re-checked every m_IdleCheckS, so cost follows the
+//   number of occupied areas rather than the number of bases on the map
+// - Going IDLE runs one last trigger query first, so the trigger doesn't keep
+//   (and a running seize doesn't act on) occupants that just died or left
+// -----------------------------------------------------------------------------
+
+enum CAV_ESeizingTier
+{
+	IDLE,
+	NEARBY,
+	ACTIVE
+}
+
+class CAV_SeizingSchedulerSystem : GameSystem
+{
+	[Attribute(defvalue: "1", uiwidget: UIWidgets.CheckBox, desc: "Scale seizing evaluation with nearby activity")]
+	protected bool m_Active;
+
+	[Attribute(defvalue: "250", uiwidget: UIWidgets.EditBox, desc: "Character grid cell size (m)", params: "50 2000 10")]
+	protected float m_CellSize;
+
+	[Attribute(defvalue: "300", uiwidget: UIWidgets.EditBox, desc: "Distance beyond the seizing radius that wakes a base (m)", params: "0 3000 10")]
+	protected float m_WakeMargin;
+
+	[Attribute(defvalue: "1", uiwidget: UIWidgets.EditBox, desc: "Trigger query interval while characters are inside the radius (s)", params: "0.1 10 0.1")]
+	protected float m_ActiveRateS;
+
+	[Attribute(defvalue: "5", uiwidget: UIWidgets.EditBox, desc: "Trigger query interval while characters are only close by (s)", params: "0.5 60 0.5")]
+	protected float m_NearbyRateS;
+
+	[Attribute(defvalue: "2", uiwidget: UIWidgets.EditBox, desc: "Seconds between character grid rebuilds and tier checks of awake bases", params: "0.25 30 0.25")]
+	protected float m_GridRebuildS;
+
+	[Attribute(defvalue: "10", uiwidget: UIWidgets.EditBox, desc: "Seconds between tier checks of idle bases", params: "1 120 1")]
+	protected float m_IdleCheckS;
+
+	// --- Bases (parallel, swap-removed) --------------------------------------
+	protected ref array<SCR_SeizingComponent> m_Bases = {};
+	protected ref array<CAV_ESeizingTier> m_Tiers = {};
+	protected ref array<float> m_NextCheckS = {};
+
+	// --- Characters ----------------------------------------------------------
+	protected ref CAV_SpatialGrid m_CharacterGrid;
+	protected ref array<vector> m_CharacterPositions = {};
+	protected ref array<AIAgent> m_Agents = {};
+	protected ref array<int> m_Candidates = {};
+	protected float m_NextRebuildS;
+
+	//------------------------------------------------------------------------------------------------
+	override static void InitInfo(WorldSystemInfo outInfo)
+	{
+		outInfo
+			.SetAbstract(false)
+			.SetLocation(ESystemLocation.Server)
+			.AddPoint(ESystemPoint.Frame);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	static CAV_SeizingSchedulerSystem GetInstance()
+	{
+		World world = GetGame().GetWorld();
+		if (!world) return null;
+		return CAV_SeizingSchedulerSystem.Cast(world.FindSystem(CAV_SeizingSchedulerSystem));
+	}
+
+	//------------------------------------------------------------------------------------------------
+	override protected void OnInit()
+	{
+		m_CharacterGrid = new CAV_SpatialGrid(m_CellSize);
+		Enable(false);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	bool IsActive()
+	{
+		return m_Active;
+	}
+
+	// --- Registration --------------------------------------------------------
+	void Register(notnull SCR_SeizingComponent seizing)
+	{
+		if (m_Bases.Contains(seizing)) return;
+
+		m_Bases.Insert(seizing);
+		m_Tiers.Insert(CAV_ESeizingTier.ACTIVE);
+		m_NextCheckS.Insert(0); // first pass settles the real tier
+
+		Enable(true);
+	}
+
+	void Unregister(SCR_SeizingComponent seizing)
+	{
+		int i = m_Bases.Find(seizing);
+		if (i == -1) return;
+
+		m_Bases.Remove(i);
+		m_Tiers.Remove(i);
+		m_NextCheckS.Remove(i);
+	}
+
+	// --- Frame update --------------------------------------------------------
+	override protected void OnUpdate(ESystemPoint point)
+	{
+		float nowS = GetWorld().GetWorldTime() * 0.001;
+		if (nowS < m_NextRebuildS) return;
+		m_NextRebuildS = nowS + m_GridRebuildS;
+
+		CAV_PerfScope perfScope = CAV_Perf.Scope("seize.frame_ms");
+
+		RebuildCharacterGrid();
+
+		int checked, idle, nearby, active;
+		for (int i = m_Bases.Count() - 1; i >= 0; i--)
+		{
+			SCR_SeizingComponent seizing = m_Bases[i];
+			if (!seizing)
+			{
+				m_Bases.Remove(i);
+				m_Tiers.Remove(i);
+				m_NextCheckS.Remove(i);
+				continue;
+			}
+
+			if (nowS >= m_NextCheckS[i])
+			{
+				CAV_ESeizingTier tier = Classify(seizing);
+				// Trigger may not exist yet right after init; retried next pass
+				if (tier != m_Tiers[i] && ApplyTier(seizing, tier))
+					m_Tiers[i] = tier;
+
+				if (tier == CAV_ESeizingTier.IDLE)
+					m_NextCheckS[i] = nowS + m_IdleCheckS;
+				else
+					m_NextCheckS[i] = nowS; // awake bases follow every rebuild
+
+				checked++;
+			}
+
+			switch (m_Tiers[i])
+			{
+				case CAV_ESeizingTier.IDLE: idle++; break;
+				case CAV_ESeizingTier.NEARBY: nearby++; break;
+				case CAV_ESeizingTier.ACTIVE: active++; break;
+			}
+		}
+
+		CAV_Perf.Count("seize.checked", checked);
+		CAV_Perf.Sample("seize.idle", idle);
+		CAV_Perf.Sample("seize.nearby", nearby);
+		CAV_Perf.Sample("seize.active", active);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected void RebuildCharacterGrid()
+	{
+		m_CharacterGrid.Clear();
+		CAV_SpatialGrid.GatherPlayerPositions(m_CharacterPositions);
+
+		AIWorld aiWorld = GetGame().GetAIWorld();
+		if (aiWorld)
+		{
+			m_Agents.Clear();
+			aiWorld.GetAIAgents(m_Agents);
+			foreach (AIAgent agent : m_Agents)
+			{
+				IEntity controlled = agent.GetControlledEntity();
+				if (controlled && ChimeraCharacter.Cast(controlled))
+					m_CharacterPositions.Insert(controlled.GetOrigin());
+			}
+		}
+
+		foreach (int id, vector pos : m_CharacterPositions)
+		{
+			m_CharacterGrid.Insert(id, pos);
+		}
+
+		CAV_Perf.Sample("seize.characters", m_CharacterPositions.Count());
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected CAV_ESeizingTier Classify(SCR_SeizingComponent seizing)
+	{
+		vector center = seizing.GetOwner().GetOrigin();
+		float radius = seizing.CAV_GetSeizingRadius();
+		float wakeRadius = radius + m_WakeMargin;
+
+		if (!m_CharacterGrid.AnyInRadius(center, wakeRadius))
+			return CAV_ESeizingTier.IDLE;
+
+		m_Candidates.Clear();
+		m_CharacterGrid.QueryRadius(center, wakeRadius, m_Candidates);
+
+		float radiusSq = radius * radius;
+		float wakeSq = wakeRadius * wakeRadius;
+		CAV_ESeizingTier tier = CAV_ESeizingTier.IDLE;
+
+		foreach (int id : m_Candidates)
+		{
+			float d = vector.DistanceSqXZ(m_CharacterPositions[id], center);
+			if (d <= radiusSq)
+				return CAV_ESeizingTier.ACTIVE;
+			if (d <= wakeSq)
+				tier = CAV_ESeizingTier.NEARBY;
+		}
+
+		return tier;
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected bool ApplyTier(SCR_SeizingComponent seizing, CAV_ESeizingTier tier)
+	{
+		bool applied;
+		switch (tier)
+		{
+			case CAV_ESeizingTier.IDLE:
+				applied = seizing.CAV_SetQueryRate(false, 0);
+				break;
+			case CAV_ESeizingTier.NEARBY:
+				applied = seizing.CAV_SetQueryRate(true, m_NearbyRateS);
+				break;
+			case CAV_ESeizingTier.ACTIVE:
+				applied = seizing.CAV_SetQueryRate(true, m_ActiveRateS);
+				break;
+		}
+
+		if (applied)
+			CAV_Perf.Count("seize.tier_changes");
+		return applied;
+	}
+}
+
+// ---- Hand seizing trigger cadence to the scheduler
+modded class SCR_SeizingComponent
+{
+	override void OnPostInit(IEntity owner)
+	{
+		super.OnPostInit(owner);
+
+		if (!Replication.IsServer())
+			return;
+
+		CAV_SeizingSchedulerSystem scheduler = CAV_SeizingSchedulerSystem.GetInstance();
+		if (scheduler && scheduler.IsActive())
+			scheduler.Register(this);
+	}
+
+	override void OnDelete(IEntity owner)
+	{
+		CAV_SeizingSchedulerSystem scheduler = CAV_SeizingSchedulerSystem.GetInstance();
+		if (scheduler)
+			scheduler.Unregister(this);
+
+		super.OnDelete(owner);
+	}
+
+	float CAV_GetSeizingRadius()
+	{
+		if (m_Trigger)
+			return m_Trigger.GetSphereRadius();
+		return 0;
+	}
+
+	bool CAV_SetQueryRate(bool enabled, float intervalS)
+	{
+		if (!m_Trigger)
+			return false;
+
+		// Refresh the result set before it is frozen
+		if (!enabled)
+			m_Trigger.QueryEntitiesInside();
+
+		m_Trigger.EnablePeriodicQueries(enabled);
+		if (enabled)
+			m_Trigger.SetUpdateRate(intervalS);
+		return true;
+	}
+}
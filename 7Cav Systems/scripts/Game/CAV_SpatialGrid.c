@@ -0,0 +1,165 @@
+// -----------------------------------------------------------------------------
+// CAV_SpatialGrid.c
+// - Uniform 2D (XZ) bucket grid of integer ids for proximity queries
+// - Ids are the caller's own indices; the grid never touches entities
+// - QueryRadius returns candidates from overlapping cells; callers do the exact
+//   distance test, which keeps the grid itself trivial
+// -----------------------------------------------------------------------------
+
+class CAV_SpatialGrid
+{
+	protected float m_CellSize;
+	protected ref map<int, ref array<int>> m_Cells = new map<int, ref array<int>>();
+
+	// Cell coords are offset so negative world positions still pack into one int
+	protected static const int CELL_OFFSET = 32768;
+	protected static const int CELL_STRIDE = 65536;
+
+	protected static ref ScriptInvoker s_OnGatherPlayerPositions;
+
+	void CAV_SpatialGrid(float cellSize)
+	{
+		m_CellSize = Math.Max(cellSize, 1);
+	}
+
+	float GetCellSize()
+	{
+		return m_CellSize;
+	}
+
+	int CellKey(vector pos)
+	{
+		int cx = Math.Floor(pos[0] / m_CellSize) + CELL_OFFSET;
+		int cz = Math.Floor(pos[2] / m_CellSize) + CELL_OFFSET;
+		return cx * CELL_STRIDE + cz;
+	}
+
+	void Insert(int id, vector pos)
+	{
+		int key = CellKey(pos);
+		array<int> cell = m_Cells.Get(key);
+		if (!cell)
+		{
+			cell = {};
+			m_Cells.Insert(key, cell);
+		}
+		cell.Insert(id);
+	}
+
+	void Remove(int id, vector pos)
+	{
+		int key = CellKey(pos);
+		array<int> cell = m_Cells.Get(key);
+		if (!cell) return;
+
+		cell.RemoveItem(id);
+		if (cell.IsEmpty())
+			m_Cells.Remove(key);
+	}
+
+	// Re-bucket only when the id actually crossed a cell border
+	void Move(int id, vector from, vector to)
+	{
+		if (CellKey(from) == CellKey(to)) return;
+		Remove(id, from);
+		Insert(id, to);
+	}
+
+	// Appends every id in cells overlapping the circle; may contain false positives
+	void QueryRadius(vector center, float radius, notnull array<int> outIds)
+	{
+		int minX = Math.Floor((center[0] - radius) / m_CellSize) + CELL_OFFSET;
+		int maxX = Math.Floor((center[0] + radius) / m_CellSize) + CELL_OFFSET;
+		int minZ = Math.Floor((center[2] - radius) / m_CellSize) + CELL_OFFSET;
+		int maxZ = Math.Floor((center[2] + radius) / m_CellSize) + CELL_OFFSET;
+
+		for (int x = minX; x <= maxX; x++)
+		{
+			for (int z = minZ; z <= maxZ; z++)
+			{
+				array<int> cell = m_Cells.Get(x * CELL_STRIDE + z);
+				if (cell)
+					outIds.InsertAll(cell);
+			}
+		}
+	}
+
+	// True if any id lies in a cell overlapping the circle (cheap "anyone near?" test)
+	bool AnyInRadius(vector center, float radius)
+	{
+		int minX = Math.Floor((center[0] - radius) / m_CellSize) + CELL_OFFSET;
+		int maxX = Math.Floor((center[0] + radius) / m_CellSize) + CELL_OFFSET;
+		int minZ = Math.Floor((center[2] - radius) / m_CellSize) + CELL_OFFSET;
+		int maxZ = Math.Floor((center[2] + radius) / m_CellSize) + CELL_OFFSET;
+
+		for (int x = minX; x <= maxX; x++)
+		{
+			for (int z = minZ; z <= maxZ; z++)
+			{
+				if (m_Cells.Contains(x * CELL_STRIDE + z))
+					return true;
+			}
+		}
+		return false;
+	}
+
+	void Clear()
+	{
+		m_Cells.Clear();
+	}
+
+	// --- Player helpers ------------------------------------------------------
+	// Positions of every player-controlled, living entity. One pass over the
+	// player list per caller tick instead of one per spawn point/base/vehicle.
+	static int GatherPlayerPositions(notnull array<vector> outPositions)
+	{
+		outPositions.Clear();
+
+		PlayerManager pm = GetGame().GetPlayerManager();
+		if (!pm) return 0;
+
+		array<int> playerIds = {};
+		pm.GetPlayers(playerIds);
+
+		foreach (int playerId : playerIds)
+		{
+			IEntity ent = pm.GetPlayerControlledEntity(playerId);
+			if (!ent) continue;
+
+			ChimeraCharacter character = ChimeraCharacter.Cast(ent);
+			if (character)
+			{
+				CharacterControllerComponent ctrl = character.GetCharacterController();
+				if (ctrl && ctrl.IsDead()) continue;
+			}
+
+			outPositions.Insert(ent.GetOrigin());
+		}
+
+		// Registered sources (e.g. benchmark stand-ins) count as players
+		if (s_OnGatherPlayerPositions)
+			s_OnGatherPlayerPositions.Invoke(outPositions);
+
+		return outPositions.Count();
+	}
+
+	// Extra player positions; subscribers append to the array they're given: (array<vector>)
+	static ScriptInvoker GetOnGatherPlayerPositions()
+	{
+		if (!s_OnGatherPlayerPositions)
+			s_OnGatherPlayerPositions = new ScriptInvoker();
+		return s_OnGatherPlayerPositions;
+	}
+
+	// Squared XZ distance from pos to the nearest of the given positions
+	static float MinDistanceSq2D(vector pos, notnull array<vector> positions)
+	{
+		float best = float.MAX;
+		foreach (vector p : positions)
+		{
+			float d = vector.DistanceSqXZ(pos, p);
+			if (d < best) best = d;
+		}
+		return best;
+	}
+}
@@ -0,0 +1,535 @@
+// -----------------------------------------------------------------------------
+// CAV_SupplyLedgerSystem.c
+// - Server keeps one supply total per area: a military base (by callsign) for
+//   containers inside its radius, otherwise a m_CellSize grid cell
+// - Containers on vehicles (parked trucks included) never count toward a base,
+//   only toward the grid cell they're in, re-homed every m_MobileRecheckS
+// - Container changes only mark the container dirty; totals are settled once
+//   per m_FlushIntervalS, so a logistics run that moves crates box by box
+//   costs one update per area, not one per box
+// - Clients subscribe on first query and receive (area, total) pairs for the
+//   areas that changed, with a revision; a missed step refetches everything
+// - Lookups are a map read on either side. The build menu's supply query on a
+//   provider inside a base reads the base total (see bottom)
+// - Virtual containers only mirror physical ones and are not counted
+//
+// Usage (client UI):
+//   CAV_SupplyLedgerSystem ledger = CAV_SupplyLedgerSystem.GetInstance();
+//   float supplies = ledger.GetBaseSupplies(base);
+//   ledger.GetOnTotalsChanged().Insert(OnSupplyTotals);   // ()
+// -----------------------------------------------------------------------------
+
+// ---- Server: one tracked supply container
+class CAV_SupplyLedgerEntry
+{
+	SCR_ResourceComponent m_Component;
+	SCR_ResourceContainer m_Container;
+	int m_AreaId;
+	float m_Value;          // value currently booked to m_AreaId
+	bool m_Booked;
+	bool m_Dirty;
+	bool m_Mobile;
+}
+
+class CAV_SupplyLedgerSystem : GameSystem
+{
+	[Attribute(defvalue: "1", uiwidget: UIWidgets.EditBox, desc: "Seconds between settling container changes into area totals", params: "0.1 30 0.1")]
+	protected float m_FlushIntervalS;
+
+	[Attribute(defvalue: "5", uiwidget: UIWidgets.EditBox, desc: "Seconds between area re-checks of containers on vehicles", params: "1 60 1")]
+	protected float m_MobileRecheckS;
+
+	[Attribute(defvalue: "1000", uiwidget: UIWidgets.EditBox, desc: "Grid cell size for containers outside any base (m)", params: "100 5000 50")]
+	protected float m_CellSize;
+
+	[Attribute(defvalue: "1", uiwidget: UIWidgets.EditBox, desc: "Area totals that moved less than this are not sent to clients", params: "0 100 0.5")]
+	protected float m_MinSendDelta;
+
+	// --- Server --------------------------------------------------------------
+	protected ref array<SCR_ResourceComponent> m_PendingComponents = {};
+	protected ref map<SCR_ResourceContainer, ref CAV_SupplyLedgerEntry> m_Entries = new map<SCR_ResourceContainer, ref CAV_SupplyLedgerEntry>();
+	protected ref array<CAV_SupplyLedgerEntry> m_Dirty = {};
+	protected ref array<CAV_SupplyLedgerEntry> m_Mobile = {};
+	protected ref map<int, float> m_Sent = new map<int, float>();     // last total each area was sent at
+	protected ref set<int> m_Changed = new set<int>();
+	protected ref array<SCR_MilitaryBaseComponent> m_Bases = {};
+	protected ref array<int> m_Subscribers = {};
+	protected int m_Revision;
+	protected bool m_Settled;
+	protected float m_NextFlushS;
+	protected float m_NextMobileS;
+
+	// --- Both ----------------------------------------------------------------
+	protected ref map<int, float> m_Totals = new map<int, float>();
+
+	// --- Client --------------------------------------------------------------
+	protected int m_ClientRevision = -1;
+	protected bool m_Subscribed;
+	protected bool m_AwaitingFull;
+	protected ref ScriptInvoker m_OnTotalsChanged;
+
+	//------------------------------------------------------------------------------------------------
+	override static void InitInfo(WorldSystemInfo outInfo)
+	{
+		outInfo
+			.SetAbstract(false)
+			.SetLocation(ESystemLocation.Both)
+			.AddPoint(ESystemPoint.Frame);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	static CAV_SupplyLedgerSystem GetInstance()
+	{
+		World world = GetGame().GetWorld();
+		if (!world) return null;
+		return CAV_SupplyLedgerSystem.Cast(world.FindSystem(CAV_SupplyLedgerSystem));
+	}
+
+	//------------------------------------------------------------------------------------------------
+	override protected void OnInit()
+	{
+		// Server enables itself when containers register; clients never tick
+		Enable(false);
+	}
+
+	// --- Areas ---------------------------------------------------------------
+	// Same answer on server and client: base callsign, or a negative cell id
+	int GetAreaId(vector pos)
+	{
+		SCR_MilitaryBaseComponent base = FindBase(pos);
+		if (base && base.GetCallsign() >= 0)
+			return base.GetCallsign();
+
+		return GetCellId(pos);
+	}
+
+	protected int GetCellId(vector pos)
+	{
+		int cx = Math.Clamp(Math.Floor(pos[0] / m_CellSize), 0, 4095);
+		int cz = Math.Clamp(Math.Floor(pos[2] / m_CellSize), 0, 4095);
+		return -1 - (cx * 4096 + cz);
+	}
+
+	protected void RefreshBases()
+	{
+		m_Bases.Clear();
+		SCR_MilitaryBaseSystem baseSystem = SCR_MilitaryBaseSystem.GetInstance();
+		if (baseSystem)
+			baseSystem.GetBases(m_Bases);
+	}
+
+	protected SCR_MilitaryBaseComponent FindBase(vector pos)
+	{
+		if (m_Bases.IsEmpty())
+			RefreshBases();
+
+		SCR_MilitaryBaseComponent best;
+		float bestSq = float.MAX;
+		foreach (SCR_MilitaryBaseComponent base : m_Bases)
+		{
+			if (!base) continue;
+
+			float distSq = vector.DistanceSqXZ(base.GetOwner().GetOrigin(), pos);
+			float radius = base.GetRadius();
+			if (distSq <= radius * radius && distSq < bestSq)
+			{
+				best = base;
+				bestSq = distSq;
+			}
+		}
+		return best;
+	}
+
+	// --- Queries (O(1)) -------------------------------------------------------
+	float GetSupplies(int areaId)
+	{
+		if (!Replication.IsServer())
+			EnsureSubscribed();
+
+		return m_Totals.Get(areaId);
+	}
+
+	// Containers stored inside the base radius; bases without a callsign have no total
+	float GetBaseSupplies(notnull SCR_MilitaryBaseComponent base)
+	{
+		int callsign = base.GetCallsign();
+		if (callsign < 0)
+			return 0;
+
+		return GetSupplies(callsign);
+	}
+
+	// False until the server has settled its first flush, or the client has its
+	// first full set; callers fall back to their own lookup meanwhile
+	bool IsReady()
+	{
+		if (Replication.IsServer())
+			return m_Settled;
+
+		EnsureSubscribed();
+		return m_Subscribed && !m_AwaitingFull;
+	}
+
+	// Base whose radius holds the position, or null
+	SCR_MilitaryBaseComponent GetBaseAt(vector pos)
+	{
+		return FindBase(pos);
+	}
+
+	// Invoked on clients whenever received totals change
+	ScriptInvoker GetOnTotalsChanged()
+	{
+		if (!m_OnTotalsChanged)
+			m_OnTotalsChanged = new ScriptInvoker();
+		return m_OnTotalsChanged;
+	}
+
+	// =================================================================================================
+	// CLIENT
+	// =================================================================================================
+
+	protected void EnsureSubscribed()
+	{
+		if (m_Subscribed) return;
+
+		SCR_PlayerController pc = SCR_PlayerController.Cast(GetGame().GetPlayerController());
+		if (!pc) return;
+
+		m_Subscribed = true;
+		m_AwaitingFull = true;
+		pc.CAV_AskSupplyTotals(m_ClientRevision);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	void ClientOnTotals(bool full, int baseRevision, int revision, array<int> areaIds, array<float> totals)
+	{
+		if (full)
+		{
+			m_Totals.Clear();
+			m_AwaitingFull = false;
+		}
+		else if (m_AwaitingFull)
+		{
+			return;
+		}
+		else if (baseRevision != m_ClientRevision)
+		{
+			// Missed a step: refetch everything
+			m_AwaitingFull = true;
+			SCR_PlayerController pc = SCR_PlayerController.Cast(GetGame().GetPlayerController());
+			if (pc)
+				pc.CAV_AskSupplyTotals(-1);
+			return;
+		}
+
+		foreach (int i, int areaId : areaIds)
+		{
+			m_Totals.Set(areaId, totals[i]);
+		}
+		m_ClientRevision = revision;
+
+		if (m_OnTotalsChanged)
+			m_OnTotalsChanged.Invoke();
+	}
+
+	// =================================================================================================
+	// SERVER
+	// =================================================================================================
+
+	void Register(notnull SCR_ResourceComponent component)
+	{
+		if (!Replication.IsServer()) return;
+
+		// Containers may not be set up yet; picked up on the next flush
+		m_PendingComponents.Insert(component);
+		Enable(true);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	void Unregister(notnull SCR_ResourceComponent component)
+	{
+		if (!Replication.IsServer()) return;
+
+		m_PendingComponents.RemoveItem(component);
+
+		SCR_ResourceContainer container = component.GetContainer(EResourceType.SUPPLIES);
+		if (!container) return;
+
+		CAV_SupplyLedgerEntry entry = m_Entries.Get(container);
+		if (!entry) return;
+
+		container.GetOnResourcesChanged().Remove(OnContainerChanged);
+		Unbook(entry);
+		m_Dirty.RemoveItem(entry);
+		m_Mobile.RemoveItem(entry);
+		m_Entries.Remove(container);
+		Enable(true);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected void OnContainerChanged(SCR_ResourceContainer container, float previousValue)
+	{
+		CAV_SupplyLedgerEntry entry = m_Entries.Get(container);
+		if (!entry || entry.m_Dirty) return;
+
+		entry.m_Dirty = true;
+		m_Dirty.Insert(entry);
+		CAV_Perf.Count("supply.container_changes");
+		Enable(true);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	void ServerOnAsk(notnull SCR_PlayerController pc, int knownRevision)
+	{
+		int playerId = pc.GetPlayerId();
+		if (!m_Subscribers.Contains(playerId))
+			m_Subscribers.Insert(playerId);
+
+		if (knownRevision == m_Revision)
+			return;
+
+		array<int> areaIds = {};
+		array<float> totals = {};
+		foreach (int areaId, float total : m_Totals)
+		{
+			areaIds.Insert(areaId);
+			totals.Insert(total);
+		}
+
+		pc.CAV_SendSupplyTotals(true, -1, m_Revision, areaIds, totals);
+		CAV_Perf.Count("supply.full_sent");
+	}
+
+	//------------------------------------------------------------------------------------------------
+	override protected void OnUpdate(ESystemPoint point)
+	{
+		float nowS = GetWorld().GetWorldTime() * 0.001;
+		if (nowS < m_NextFlushS) return;
+		m_NextFlushS = nowS + m_FlushIntervalS;
+
+		CAV_PerfScope perfScope = CAV_Perf.Scope("supply.flush_ms");
+
+		AdoptPending();
+
+		foreach (CAV_SupplyLedgerEntry entry : m_Dirty)
+		{
+			entry.m_Dirty = false;
+			if (!entry.m_Container) continue;
+
+			Unbook(entry);
+			Book(entry, entry.m_AreaId);
+		}
+		m_Dirty.Clear();
+		m_Settled = true;
+
+		if (nowS >= m_NextMobileS)
+		{
+			m_NextMobileS = nowS + m_MobileRecheckS;
+			RehomeMobile();
+		}
+
+		Send();
+
+		if (m_PendingComponents.IsEmpty() && m_Dirty.IsEmpty() && m_Mobile.IsEmpty())
+			Enable(false);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected void AdoptPending()
+	{
+		if (m_PendingComponents.IsEmpty()) return;
+
+		// Bases may still have been registering when the last batch came in
+		RefreshBases();
+
+		foreach (SCR_ResourceComponent component : m_PendingComponents)
+		{
+			if (!component) continue;
+
+			SCR_ResourceContainer container = component.GetContainer(EResourceType.SUPPLIES);
+			if (!container || SCR_ResourceContainerVirtual.Cast(container) || m_Entries.Contains(container))
+				continue;
+
+			IEntity root = component.GetOwner().GetRootParent();
+
+			CAV_SupplyLedgerEntry entry = new CAV_SupplyLedgerEntry();
+			entry.m_Component = component;
+			entry.m_Container = container;
+			entry.m_Mobile = Vehicle.Cast(root) != null;
+			m_Entries.Insert(container, entry);
+
+			if (entry.m_Mobile)
+				m_Mobile.Insert(entry);
+
+			container.GetOnResourcesChanged().Insert(OnContainerChanged);
+			Book(entry, GetEntryAreaId(entry));
+		}
+
+		m_PendingComponents.Clear();
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected void RehomeMobile()
+	{
+		for (int i = m_Mobile.Count() - 1; i >= 0; i--)
+		{
+			CAV_SupplyLedgerEntry entry = m_Mobile[i];
+			if (!entry.m_Component || !entry.m_Container)
+			{
+				m_Mobile.Remove(i);
+				continue;
+			}
+
+			int areaId = GetEntryAreaId(entry);
+			if (areaId == entry.m_AreaId) continue;
+
+			Unbook(entry);
+			Book(entry, areaId);
+			CAV_Perf.Count("supply.rehomed");
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------
+	// Vehicle cargo is in transit, not base stock
+	protected int GetEntryAreaId(CAV_SupplyLedgerEntry entry)
+	{
+		vector pos = entry.m_Component.GetOwner().GetRootParent().GetOrigin();
+		if (entry.m_Mobile)
+			return GetCellId(pos);
+
+		return GetAreaId(pos);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected void Book(CAV_SupplyLedgerEntry entry, int areaId)
+	{
+		entry.m_AreaId = areaId;
+		entry.m_Value = entry.m_Container.GetResourceValue();
+		entry.m_Booked = true;
+
+		m_Totals.Set(areaId, m_Totals.Get(areaId) + entry.m_Value);
+		m_Changed.Insert(areaId);
+	}
+
+	protected void Unbook(CAV_SupplyLedgerEntry entry)
+	{
+		if (!entry.m_Booked) return;
+
+		entry.m_Booked = false;
+		m_Totals.Set(entry.m_AreaId, Math.Max(0, m_Totals.Get(entry.m_AreaId) - entry.m_Value));
+		m_Changed.Insert(entry.m_AreaId);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	// One message per subscriber with every area that moved enough since it was last sent
+	protected void Send()
+	{
+		if (m_Changed.IsEmpty()) return;
+
+		array<int> areaIds = {};
+		array<float> totals = {};
+		foreach (int areaId : m_Changed)
+		{
+			float total = m_Totals.Get(areaId);
+			float sent;
+			if (m_Sent.Find(areaId, sent) && Math.AbsFloat(total - sent) < m_MinSendDelta)
+				continue;
+
+			m_Sent.Set(areaId, total);
+			areaIds.Insert(areaId);
+			totals.Insert(total);
+		}
+		m_Changed.Clear();
+
+		CAV_Perf.Sample("supply.areas_changed", areaIds.Count());
+		if (areaIds.IsEmpty()) return;
+
+		int baseRevision = m_Revision;
+		m_Revision++;
+
+		PlayerManager pm = GetGame().GetPlayerManager();
+		for (int s = m_Subscribers.Count() - 1; s >= 0; s--)
+		{
+			SCR_PlayerController pc = SCR_PlayerController.Cast(pm.GetPlayerController(m_Subscribers[s]));
+			if (!pc)
+			{
+				m_Subscribers.Remove(s);
+				continue;
+			}
+			pc.CAV_SendSupplyTotals(false, baseRevision, m_Revision, areaIds, totals);
+		}
+
+		CAV_Perf.Count("supply.updates_sent", m_Subscribers.Count());
+	}
+}
+
+// ---- Feed every resource component into the ledger
+modded class SCR_ResourceComponent
+{
+	override void OnPostInit(IEntity owner)
+	{
+		super.OnPostInit(owner);
+
+		CAV_SupplyLedgerSystem ledger = CAV_SupplyLedgerSystem.GetInstance();
+		if (ledger)
+			ledger.Register(this);
+	}
+
+	override void OnDelete(IEntity owner)
+	{
+		CAV_SupplyLedgerSystem ledger = CAV_SupplyLedgerSystem.GetInstance();
+		if (ledger)
+			ledger.Unregister(this);
+
+		super.OnDelete(owner);
+	}
+}
+
+// ---- Build menu: a provider inside a base reads the base total
+modded class SCR_CampaignBuildingProviderComponent
+{
+	override float GetCurrentResourceValue()
+	{
+		CAV_SupplyLedgerSystem ledger = CAV_SupplyLedgerSystem.GetInstance();
+		if (!ledger || !ledger.IsReady())
+			return super.GetCurrentResourceValue();
+
+		SCR_MilitaryBaseComponent base = ledger.GetBaseAt(GetOwner().GetOrigin());
+		if (!base || base.GetCallsign() < 0)
+			return super.GetCurrentResourceValue();
+
+		return ledger.GetBaseSupplies(base);
+	}
+}
+
+// ---- Transport over the player's own controller
+modded class SCR_PlayerController
+{
+	//------------------------------------------------------------------------------------------------
+	void CAV_AskSupplyTotals(int knownRevision)
+	{
+		Rpc(CAV_RpcAsk_SupplyTotals, knownRevision);
+	}
+
+	[RplRpc(RplChannel.Reliable, RplRcver.Server)]
+	protected void CAV_RpcAsk_SupplyTotals(int knownRevision)
+	{
+		CAV_SupplyLedgerSystem ledger = CAV_SupplyLedgerSystem.GetInstance();
+		if (ledger)
+			ledger.ServerOnAsk(this, knownRevision);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	void CAV_SendSupplyTotals(bool full, int baseRevision, int revision, array<int> areaIds, array<float> totals)
+	{
+		Rpc(CAV_RpcDo_SupplyTotals, full, baseRevision, revision, areaIds, totals);
+	}
+
+	[RplRpc(RplChannel.Reliable, RplRcver.Owner)]
+	protected void CAV_RpcDo_SupplyTotals(bool full, int baseRevision, int revision, array<int> areaIds, array<float> totals)
+	{
+		CAV_SupplyLedgerSystem ledger = CAV_SupplyLedgerSystem.GetInstance();
+		if (ledger)
+			ledger.ClientOnTotals(full, baseRevision, revision, areaIds, totals);
+	}
+}
@@ -0,0 +1,438 @@
+// -----------------------------------------------------------------------------
+// CAV_VehicleVirtualizationSystem.c
+// - Vehicles spawned by SCR_AmbientVehicleSpawnPointComponent are adopted
+// - An adopted vehicle that is empty, still parked where it spawned and has no
+//   player within m_VirtualizeRadius for m_VirtualizeDelayS collapses into a
+//   CAV_VirtualVehicleRecord (prefab, transform, fuel, hull health) and the
+//   entity is deleted
+// - A player coming within m_RehydrateRadius respawns it through its spawn
+//   point's own SpawnVehicle, so every vanilla handler is installed again, then
+//   moves it to the recorded transform and restores fuel and health
+// - A vehicle players have driven off is released: cargo and attachments are
+//   not recorded, so it is left to the garbage system instead
+// - Virtual records sit in a CAV_SpatialGrid, same as CAV_AIVirtualizationSystem
+// -----------------------------------------------------------------------------
+
+class CAV_VirtualVehicleRecord
+{
+	ResourceName m_Prefab;
+	vector m_Transform[4];
+	float m_Fuel = 1;          // fraction of total capacity
+	float m_Health = 1;        // hull, scaled
+
+	Vehicle m_Vehicle;         // live vehicle, null while virtual
+	SCR_AmbientVehicleSpawnPointComponent m_SpawnPoint;
+	bool m_Virtual;
+	float m_FarSinceS = -1;    // -1 while observed
+	int m_SeenStamp;
+}
+
+class CAV_VehicleVirtualizationSystem : GameSystem
+{
+	[Attribute(defvalue: "1", uiwidget: UIWidgets.CheckBox, desc: "Virtualize distant, untouched ambient vehicles")]
+	protected bool m_Active;
+
+	[Attribute(defvalue: "500", uiwidget: UIWidgets.EditBox, desc: "Grid cell size (m)", params: "50 5000 10")]
+	protected float m_CellSize;
+
+	[Attribute(defvalue: "1200", uiwidget: UIWidgets.EditBox, desc: "Virtualize a vehicle when every player is beyond this range (m)", params: "100 8000 10")]
+	protected float m_VirtualizeRadius;
+
+	[Attribute(defvalue: "1000", uiwidget: UIWidgets.EditBox, desc: "Rehydrate a virtual vehicle when a player is within this range (m); keep < virtualize radius", params: "100 8000 10")]
+	protected float m_RehydrateRadius;
+
+	[Attribute(defvalue: "30", uiwidget: UIWidgets.EditBox, desc: "Seconds a vehicle must stay unobserved before it is virtualized", params: "0 600 1")]
+	protected float m_VirtualizeDelayS;
+
+	[Attribute(defvalue: "15", uiwidget: UIWidgets.EditBox, desc: "A vehicle moved further than this from its spawn counts as used and is released (m)", params: "1 500 1")]
+	protected float m_MovedTolerance;
+
+	[Attribute(defvalue: "3", uiwidget: UIWidgets.EditBox, desc: "Seconds between proximity evaluations", params: "0.25 30 0.25")]
+	protected float m_EvaluateIntervalS;
+
+	[Attribute(defvalue: "2", uiwidget: UIWidgets.EditBox, desc: "Max vehicles virtualized per frame", params: "1 32 1")]
+	protected int m_MaxVirtualizePerFrame;
+
+	[Attribute(defvalue: "1", uiwidget: UIWidgets.EditBox, desc: "Max vehicles rehydrated per frame", params: "1 16 1")]
+	protected int m_MaxRehydratePerFrame;
+
+	// --- State ---------------------------------------------------------------
+	// Record ids index m_Records and are never reused; a dropped record is null
+	protected ref array<ref CAV_VirtualVehicleRecord> m_Records = {};
+	protected ref map<Vehicle, int> m_IdByVehicle = new map<Vehicle, int>();
+	protected ref array<int> m_LiveIds = {};
+	protected ref CAV_SpatialGrid m_VirtualGrid;
+	protected int m_VirtualCount;
+
+	protected ref array<int> m_VirtualizeQueue = {};
+	protected ref array<int> m_RehydrateQueue = {};
+
+	protected ref array<vector> m_PlayerPositions = {};
+	protected ref array<int> m_Candidates = {};
+	protected ref array<IEntity> m_Occupants = {};
+	protected int m_EvalStamp;
+	protected float m_NextEvalS;
+
+	//------------------------------------------------------------------------------------------------
+	override static void InitInfo(WorldSystemInfo outInfo)
+	{
+		outInfo
+			.SetAbstract(false)
+			.SetLocation(ESystemLocation.Server)
+			.AddPoint(ESystemPoint.Frame);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	static CAV_VehicleVirtualizationSystem GetInstance()
+	{
+		World world = GetGame().GetWorld();
+		if (!world) return null;
+		return CAV_VehicleVirtualizationSystem.Cast(world.FindSystem(CAV_VehicleVirtualizationSystem));
+	}
+
+	//------------------------------------------------------------------------------------------------
+	override protected void OnInit()
+	{
+		m_VirtualGrid = new CAV_SpatialGrid(m_CellSize);
+		if (m_RehydrateRadius > m_VirtualizeRadius)
+			m_RehydrateRadius = m_VirtualizeRadius;
+
+		Enable(false);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	bool IsActive()
+	{
+		return m_Active;
+	}
+
+	// --- Adoption ------------------------------------------------------------
+	void Adopt(notnull Vehicle vehicle, SCR_AmbientVehicleSpawnPointComponent spawnPoint)
+	{
+		if (m_IdByVehicle.Contains(vehicle)) return;
+
+		CAV_VirtualVehicleRecord rec = new CAV_VirtualVehicleRecord();
+		rec.m_Prefab = GetPrefabName(vehicle);
+		rec.m_Vehicle = vehicle;
+		rec.m_SpawnPoint = spawnPoint;
+		vehicle.GetWorldTransform(rec.m_Transform);
+
+		int id = m_Records.Insert(rec);
+		m_IdByVehicle.Insert(vehicle, id);
+		m_LiveIds.Insert(id);
+
+		Enable(true);
+	}
+
+	int GetVirtualCount()
+	{
+		return m_VirtualCount;
+	}
+
+	// --- Frame update --------------------------------------------------------
+	override protected void OnUpdate(ESystemPoint point)
+	{
+		CAV_PerfScope perfScope = CAV_Perf.Scope("vvirt.frame_ms");
+
+		float nowS = GetNowS();
+		if (nowS >= m_NextEvalS)
+		{
+			m_NextEvalS = nowS + m_EvaluateIntervalS;
+			Evaluate(nowS);
+		}
+
+		DrainVirtualize();
+		DrainRehydrate();
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected void Evaluate(float nowS)
+	{
+		CAV_SpatialGrid.GatherPlayerPositions(m_PlayerPositions);
+		m_EvalStamp++;
+
+		float virtualizeSq = m_VirtualizeRadius * m_VirtualizeRadius;
+		float rehydrateSq = m_RehydrateRadius * m_RehydrateRadius;
+		float movedSq = m_MovedTolerance * m_MovedTolerance;
+
+		// Live vehicles: release destroyed or used ones, apply hysteresis
+		for (int i = m_LiveIds.Count() - 1; i >= 0; i--)
+		{
+			int id = m_LiveIds[i];
+			CAV_VirtualVehicleRecord rec = m_Records[id];
+			Vehicle vehicle = rec.m_Vehicle;
+
+			if (!vehicle || IsDestroyed(vehicle) || vector.DistanceSq(vehicle.GetOrigin(), rec.m_Transform[3]) > movedSq)
+			{
+				m_LiveIds.Remove(i);
+				Release(id);
+				CAV_Perf.Count("vvirt.released");
+				continue;
+			}
+
+			if (CAV_SpatialGrid.MinDistanceSq2D(vehicle.GetOrigin(), m_PlayerPositions) <= virtualizeSq || IsOccupied(vehicle))
+			{
+				rec.m_FarSinceS = -1;
+				continue;
+			}
+
+			if (rec.m_FarSinceS < 0)
+				rec.m_FarSinceS = nowS;
+			else if (nowS - rec.m_FarSinceS >= m_VirtualizeDelayS && m_VirtualizeQueue.Find(id) == -1)
+				m_VirtualizeQueue.Insert(id);
+		}
+
+		// Virtual vehicles: only cells around players
+		foreach (vector playerPos : m_PlayerPositions)
+		{
+			m_Candidates.Clear();
+			m_VirtualGrid.QueryRadius(playerPos, m_RehydrateRadius, m_Candidates);
+
+			foreach (int id : m_Candidates)
+			{
+				CAV_VirtualVehicleRecord rec = m_Records[id];
+				if (!rec || !rec.m_Virtual || rec.m_SeenStamp == m_EvalStamp) continue;
+				rec.m_SeenStamp = m_EvalStamp;
+
+				if (vector.DistanceSqXZ(rec.m_Transform[3], playerPos) > rehydrateSq) continue;
+				m_RehydrateQueue.Insert(id);
+			}
+		}
+
+		CAV_Perf.Sample("vvirt.live", m_LiveIds.Count());
+		CAV_Perf.Sample("vvirt.virtual", m_VirtualCount);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected void DrainVirtualize()
+	{
+		int done = 0;
+		while (!m_VirtualizeQueue.IsEmpty() && done < m_MaxVirtualizePerFrame)
+		{
+			int id = m_VirtualizeQueue[0];
+			m_VirtualizeQueue.RemoveOrdered(0);
+
+			CAV_VirtualVehicleRecord rec = m_Records[id];
+			if (!rec || rec.m_Virtual || !rec.m_Vehicle) continue;
+
+			// A player came back while it was queued
+			if (rec.m_FarSinceS < 0) continue;
+
+			if (Virtualize(id, rec))
+				done++;
+		}
+
+		CAV_Perf.Count("vvirt.virtualized", done);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected void DrainRehydrate()
+	{
+		int done = 0;
+		while (!m_RehydrateQueue.IsEmpty() && done < m_MaxRehydratePerFrame)
+		{
+			int id = m_RehydrateQueue[0];
+			m_RehydrateQueue.RemoveOrdered(0);
+
+			CAV_VirtualVehicleRecord rec = m_Records[id];
+			if (!rec || !rec.m_Virtual) continue;
+
+			if (Rehydrate(id, rec))
+				done++;
+		}
+
+		CAV_Perf.Count("vvirt.rehydrated", done);
+	}
+
+	// --- Collapse / restore --------------------------------------------------
+	protected bool Virtualize(int id, CAV_VirtualVehicleRecord rec)
+	{
+		Vehicle vehicle = rec.m_Vehicle;
+
+		// Someone got in between evaluation and now
+		if (IsOccupied(vehicle))
+		{
+			rec.m_FarSinceS = -1;
+			return false;
+		}
+
+		vehicle.GetWorldTransform(rec.m_Transform);
+
+		SCR_DamageManagerComponent dmg = SCR_DamageManagerComponent.Cast(vehicle.FindComponent(SCR_DamageManagerComponent));
+		if (dmg)
+			rec.m_Health = dmg.GetHealthScaled();
+
+		SCR_FuelManagerComponent fuel = SCR_FuelManagerComponent.Cast(vehicle.FindComponent(SCR_FuelManagerComponent));
+		if (fuel && fuel.GetTotalMaxFuel() > 0)
+			rec.m_Fuel = fuel.GetTotalFuel() / fuel.GetTotalMaxFuel();
+
+		m_IdByVehicle.Remove(vehicle);
+		m_LiveIds.RemoveItem(id);
+		if (rec.m_SpawnPoint)
+			rec.m_SpawnPoint.CAV_SetVirtualized(true);
+
+		SCR_EntityHelper.DeleteEntityAndChildren(vehicle);
+		rec.m_Vehicle = null;
+
+		rec.m_Virtual = true;
+		m_VirtualCount++;
+		m_VirtualGrid.Insert(id, rec.m_Transform[3]);
+		return true;
+	}
+
+	//------------------------------------------------------------------------------------------------
+	protected bool Rehydrate(int id, CAV_VirtualVehicleRecord rec)
+	{
+		Vehicle vehicle;
+		if (rec.m_SpawnPoint)
+		{
+			vehicle = rec.m_SpawnPoint.CAV_RespawnVehicle();
+			if (!vehicle) return false;
+
+			// Parked where it was recorded, which is within m_MovedTolerance of the point
+			BaseGameEntity gameEntity = BaseGameEntity.Cast(vehicle);
+			if (gameEntity)
+				gameEntity.Teleport(rec.m_Transform);
+			else
+				vehicle.SetWorldTransform(rec.m_Transform);
+		}
+		else
+		{
+			vehicle = SpawnFromRecord(rec);
+			if (!vehicle)
+			{
+				PrintFormat("[CAV_VehicleVirtualization] Cannot spawn %1, dropping record", rec.m_Prefab, level: LogLevel.WARNING);
+				m_VirtualGrid.Remove(id, rec.m_Transform[3]);
+				m_VirtualCount--;
+				Release(id);
+				return false;
+			}
+		}
+
+		if (rec.m_Health < 1)
+		{
+			SCR_DamageManagerComponent dmg = SCR_DamageManagerComponent.Cast(vehicle.FindComponent(SCR_DamageManagerComponent));
+			if (dmg)
+				dmg.SetHealthScaled(rec.m_Health);
+		}
+
+		if (rec.m_Fuel < 1)
+		{
+			SCR_FuelManagerComponent fuel = SCR_FuelManagerComponent.Cast(vehicle.FindComponent(SCR_FuelManagerComponent));
+			if (fuel)
+				fuel.SetTotalFuelPercentage(rec.m_Fuel);
+		}
+
+		rec.m_Virtual = false;
+		m_VirtualCount--;
+		rec.m_Vehicle = vehicle;
+		rec.m_FarSinceS = -1;
+
+		m_VirtualGrid.Remove(id, rec.m_Transform[3]);
+		m_IdByVehicle.Insert(vehicle, id);
+		m_LiveIds.Insert(id);
+		return true;
+	}
+
+	// A record whose spawn point is gone has no vanilla handlers to restore
+	protected Vehicle SpawnFromRecord(CAV_VirtualVehicleRecord rec)
+	{
+		Resource res = Resource.Load(rec.m_Prefab);
+		if (!res || !res.IsValid()) return null;
+
+		EntitySpawnParams params = new EntitySpawnParams();
+		params.TransformMode = ETransformMode.WORLD;
+		for (int i = 0; i < 4; i++)
+			params.Transform[i] = rec.m_Transform[i];
+
+		return Vehicle.Cast(GetGame().SpawnEntityPrefab(res, GetWorld(), params));
+	}
+
+	//------------------------------------------------------------------------------------------------
+	// Stop tracking; the vehicle (if any) stays in the world as a normal entity
+	protected void Release(int id)
+	{
+		CAV_VirtualVehicleRecord rec = m_Records[id];
+		if (!rec) return;
+
+		if (rec.m_Vehicle)
+			m_IdByVehicle.Remove(rec.m_Vehicle);
+
+		if (rec.m_SpawnPoint)
+			rec.m_SpawnPoint.CAV_SetVirtualized(false);
+
+		m_Records[id] = null;
+	}
+
+	// --- Helpers -------------------------------------------------------------
+	protected bool IsOccupied(Vehicle vehicle)
+	{
+		SCR_BaseCompartmentManagerComponent compartments = SCR_BaseCompartmentManagerComponent.Cast(vehicle.FindComponent(SCR_BaseCompartmentManagerComponent));
+		if (!compartments) return false;
+
+		m_Occupants.Clear();
+		compartments.GetOccupants(m_Occupants);
+		return !m_Occupants.IsEmpty();
+	}
+
+	protected static bool IsDestroyed(Vehicle vehicle)
+	{
+		SCR_DamageManagerComponent dmg = SCR_DamageManagerComponent.Cast(vehicle.FindComponent(SCR_DamageManagerComponent));
+		return dmg && dmg.GetState() == EDamageState.DESTROYED;
+	}
+
+	protected float GetNowS()
+	{
+		return GetWorld().GetWorldTime() * 0.001;
+	}
+
+	protected static ResourceName GetPrefabName(IEntity ent)
+	{
+		EntityPrefabData prefabData = ent.GetPrefabData();
+		if (!prefabData) return ResourceName.Empty;
+		return prefabData.GetPrefabName();
+	}
+}
+
+// ---- Hand spawned ambient vehicles over; keep the point quiet while its vehicle is virtual
+modded class SCR_AmbientVehicleSpawnPointComponent
+{
+	protected bool m_CAV_Virtualized;
+	protected bool m_CAV_Rehydrating;
+
+	override Vehicle SpawnVehicle()
+	{
+		// The record will bring the vehicle back; don't roll a fresh one
+		if (m_CAV_Virtualized)
+			return null;
+
+		Vehicle vehicle = super.SpawnVehicle();
+		if (!vehicle)
+			return null;
+
+		// A rehydrated vehicle already has its record
+		CAV_VehicleVirtualizationSystem virtualization = CAV_VehicleVirtualizationSystem.GetInstance();
+		if (virtualization && virtualization.IsActive() && !m_CAV_Rehydrating)
+			virtualization.Adopt(vehicle, this);
+
+		return vehicle;
+	}
+
+	void CAV_SetVirtualized(bool virtualized)
+	{
+		m_CAV_Virtualized = virtualized;
+	}
+
+	// Rehydrate through the vanilla spawn, so its handlers are hooked on the new vehicle
+	Vehicle CAV_RespawnVehicle()
+	{
+		m_CAV_Virtualized = false;
+		m_CAV_Rehydrating = true;
+		Vehicle vehicle = SpawnVehicle();
+		m_CAV_Rehydrating = false;
+
+		if (!vehicle)
+			m_CAV_Virtualized = true;
+		return vehicle;
+	}
+}
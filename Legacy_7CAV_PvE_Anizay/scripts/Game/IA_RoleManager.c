@@ -1,23 +1,46 @@
 	// IA_RoleManager.c
 	// A singleton class that manages player roles and enforces role limits
 	
+	// Outcome of RequestRole
+	enum IA_ERoleRequestResult
+	{
+	    ASSIGNED,
+	    WAITLISTED,
+	    REJECTED
+	}
+	
 	class IA_RoleManager
 	{
 	    // Singleton instance
 	    private static ref IA_RoleManager s_Instance;
 	    
+	    // Per-role tables, indexed directly by IA_PlayerRole (enum values are dense from 0)
+	    private int m_iRoleCount;
+	    
 	    // Role count tracking - how many players currently have each role
-	    private ref map<IA_PlayerRole, int> m_RoleCounts = new map<IA_PlayerRole, int>();
+	    private ref array<int> m_aRoleCounts = {};
 	    
 	    // Role limits - maximum number of players allowed for each role
-	    private ref map<IA_PlayerRole, int> m_RoleLimits = new map<IA_PlayerRole, int>();
+	    private ref array<int> m_aRoleLimits = {};
 	    
 	    // Player to role mapping for quick lookups
 	    private ref map<int, IA_PlayerRole> m_PlayerRoles = new map<int, IA_PlayerRole>();
 		
 		// Rank required test Garrett added
-		private ref map<IA_PlayerRole, SCR_ECharacterRank> m_RoleRequiredRanks = new map<IA_PlayerRole, SCR_ECharacterRank>();
-
+		private ref array<SCR_ECharacterRank> m_aRoleRequiredRanks = {};
+	    
+	    // Per-role FIFO waitlists, indexed by IA_PlayerRole and consumed from m_aWaitlistHeads.
+	    // Entries go stale when a player leaves or asks for another role; m_WaitingRole is the
+	    // source of truth and stale entries are skipped on pop.
+	    private ref array<ref array<int>> m_aWaitlists = {};
+	    private ref array<int> m_aWaitlistHeads = {};
+	    private ref map<int, IA_PlayerRole> m_WaitingRole = new map<int, IA_PlayerRole>();
+	    
+	    // Server-side: (int playerId, IA_PlayerRole role) when a waitlisted player gets their role
+	    private ref ScriptInvoker m_OnWaitlistPromoted = new ScriptInvoker();
+	    
+	    // Fallbacks for values outside the enum range
+	    static const int DEFAULT_ROLE_LIMIT = 999;
 	    
 	    //------------------------------------------------------------------------------------------------
 	    // SINGLETON ACCESS
@@ -39,51 +62,60 @@
 	    
 	    private void Init()
 	    {
-	        // Initialize role counts to zero
-	        m_RoleCounts[IA_PlayerRole.NONE] = 0;
-	        m_RoleCounts[IA_PlayerRole.RIFLEMAN] = 0;
-	        m_RoleCounts[IA_PlayerRole.MACHINEGUNNER] = 0;
-	        m_RoleCounts[IA_PlayerRole.GRENADIER] = 0;
-	        m_RoleCounts[IA_PlayerRole.MARKSMAN] = 0;
-	        m_RoleCounts[IA_PlayerRole.MEDIC] = 0;
-	        m_RoleCounts[IA_PlayerRole.ANTITANK_LIGHT] = 0;
-	        m_RoleCounts[IA_PlayerRole.ANTITANK_HEAVY] = 0;
-	        m_RoleCounts[IA_PlayerRole.TEAMLEADER] = 0;
-	        m_RoleCounts[IA_PlayerRole.PILOT] = 0;
-	        m_RoleCounts[IA_PlayerRole.CREWMAN] = 0;
-			m_RoleCounts[IA_PlayerRole.LOGISTIC] = 0;
+	        // Size the tables to the enum
+	        array<int> roleValues = {};
+	        SCR_Enum.GetEnumValues(IA_PlayerRole, roleValues);
+	        foreach (int value : roleValues)
+	        {
+	            if (value + 1 > m_iRoleCount)
+	                m_iRoleCount = value + 1;
+	        }
+	        
+	        m_aRoleCounts.Resize(m_iRoleCount);
+	        m_aRoleLimits.Resize(m_iRoleCount);
+	        m_aRoleRequiredRanks.Resize(m_iRoleCount);
+	        m_aWaitlistHeads.Resize(m_iRoleCount);
+	        for (int i = 0; i < m_iRoleCount; i++)
+	        {
+	            // Initialize role counts to zero
+	            m_aRoleCounts[i] = 0;
+	            m_aRoleLimits[i] = DEFAULT_ROLE_LIMIT;
+	            m_aRoleRequiredRanks[i] = SCR_ECharacterRank.INVALID;
+	            m_aWaitlists.Insert(new array<int>());
+	            m_aWaitlistHeads[i] = 0;
+	        }
 	        
 	        // Set default role limits
 	        // These can be adjusted based on game balance needs
-	        m_RoleLimits[IA_PlayerRole.NONE] = 999; // No limit for default/none role
-	        m_RoleLimits[IA_PlayerRole.RIFLEMAN] = 128; // No practical limit for riflemen
-	        m_RoleLimits[IA_PlayerRole.MACHINEGUNNER] = 8; // Example: Limit to 4 machine gunners
-	        m_RoleLimits[IA_PlayerRole.GRENADIER] = 8;
-	        m_RoleLimits[IA_PlayerRole.MARKSMAN] = 5;
-	        m_RoleLimits[IA_PlayerRole.MEDIC] = 10;
-	        m_RoleLimits[IA_PlayerRole.ANTITANK_LIGHT] = 12;
-	        m_RoleLimits[IA_PlayerRole.ANTITANK_HEAVY] = 4; // More restricted for balance
-	        m_RoleLimits[IA_PlayerRole.TEAMLEADER] = 12;
-	        m_RoleLimits[IA_PlayerRole.PILOT] = 10;
-	        m_RoleLimits[IA_PlayerRole.CREWMAN] = 10;
-			m_RoleLimits[IA_PlayerRole.LOGISTIC] = 20;
+	        m_aRoleLimits[IA_PlayerRole.NONE] = 999; // No limit for default/none role
+	        m_aRoleLimits[IA_PlayerRole.RIFLEMAN] = 128; // No practical limit for riflemen
+	        m_aRoleLimits[IA_PlayerRole.MACHINEGUNNER] = 8; // Example: Limit to 4 machine gunners
+	        m_aRoleLimits[IA_PlayerRole.GRENADIER] = 8;
+	        m_aRoleLimits[IA_PlayerRole.MARKSMAN] = 5;
+	        m_aRoleLimits[IA_PlayerRole.MEDIC] = 10;
+	        m_aRoleLimits[IA_PlayerRole.ANTITANK_LIGHT] = 12;
+	        m_aRoleLimits[IA_PlayerRole.ANTITANK_HEAVY] = 4; // More restricted for balance
+	        m_aRoleLimits[IA_PlayerRole.TEAMLEADER] = 12;
+	        m_aRoleLimits[IA_PlayerRole.PILOT] = 10;
+	        m_aRoleLimits[IA_PlayerRole.CREWMAN] = 10;
+			m_aRoleLimits[IA_PlayerRole.LOGISTIC] = 20;
 	        
 		
 		
 			//Roles Garrett add test
 			// Set required rank per role
-			m_RoleRequiredRanks[IA_PlayerRole.NONE] = SCR_ECharacterRank.PRIVATE;
-			m_RoleRequiredRanks[IA_PlayerRole.RIFLEMAN] = SCR_ECharacterRank.PRIVATE;
-			m_RoleRequiredRanks[IA_PlayerRole.MACHINEGUNNER] = SCR_ECharacterRank.CORPORAL;
-			m_RoleRequiredRanks[IA_PlayerRole.GRENADIER] = SCR_ECharacterRank.CORPORAL;
-			m_RoleRequiredRanks[IA_PlayerRole.MARKSMAN] = SCR_ECharacterRank.CORPORAL;
-			m_RoleRequiredRanks[IA_PlayerRole.MEDIC] = SCR_ECharacterRank.CORPORAL;
-			m_RoleRequiredRanks[IA_PlayerRole.ANTITANK_LIGHT] = SCR_ECharacterRank.CORPORAL;
-			m_RoleRequiredRanks[IA_PlayerRole.ANTITANK_HEAVY] = SCR_ECharacterRank.CORPORAL;
-			m_RoleRequiredRanks[IA_PlayerRole.TEAMLEADER] = SCR_ECharacterRank.CORPORAL;
-			m_RoleRequiredRanks[IA_PlayerRole.PILOT] = SCR_ECharacterRank.CORPORAL;
-			m_RoleRequiredRanks[IA_PlayerRole.CREWMAN] = SCR_ECharacterRank.CORPORAL;
-			m_RoleRequiredRanks[IA_PlayerRole.LOGISTIC] = SCR_ECharacterRank.PRIVATE;
+			m_aRoleRequiredRanks[IA_PlayerRole.NONE] = SCR_ECharacterRank.PRIVATE;
+			m_aRoleRequiredRanks[IA_PlayerRole.RIFLEMAN] = SCR_ECharacterRank.PRIVATE;
+			m_aRoleRequiredRanks[IA_PlayerRole.MACHINEGUNNER] = SCR_ECharacterRank.CORPORAL;
+			m_aRoleRequiredRanks[IA_PlayerRole.GRENADIER] = SCR_ECharacterRank.CORPORAL;
+			m_aRoleRequiredRanks[IA_PlayerRole.MARKSMAN] = SCR_ECharacterRank.CORPORAL;
+			m_aRoleRequiredRanks[IA_PlayerRole.MEDIC] = SCR_ECharacterRank.CORPORAL;
+			m_aRoleRequiredRanks[IA_PlayerRole.ANTITANK_LIGHT] = SCR_ECharacterRank.CORPORAL;
+			m_aRoleRequiredRanks[IA_PlayerRole.ANTITANK_HEAVY] = SCR_ECharacterRank.CORPORAL;
+			m_aRoleRequiredRanks[IA_PlayerRole.TEAMLEADER] = SCR_ECharacterRank.CORPORAL;
+			m_aRoleRequiredRanks[IA_PlayerRole.PILOT] = SCR_ECharacterRank.CORPORAL;
+			m_aRoleRequiredRanks[IA_PlayerRole.CREWMAN] = SCR_ECharacterRank.CORPORAL;
+			m_aRoleRequiredRanks[IA_PlayerRole.LOGISTIC] = SCR_ECharacterRank.PRIVATE;
 		
 		
 	        Print("IA_RoleManager initialized", LogLevel.NORMAL);
@@ -93,41 +125,76 @@
 	    // ROLE MANAGEMENT METHODS
 	    //------------------------------------------------------------------------------------------------
 	    
+	    // Number of slots in the per-role tables
+	    int GetRoleTableSize()
+	    {
+	        return m_iRoleCount;
+	    }
+	    
+	    private bool IsValidRole(IA_PlayerRole role)
+	    {
+	        return role >= 0 && role < m_iRoleCount;
+	    }
+	    
 	    // Check if a role has reached its limit
 	    bool IsRoleFull(IA_PlayerRole role)
 	    {
-	        // If role doesn't exist in limits map for some reason, default to allowing
-	        if (!m_RoleLimits.Contains(role))
+	        // Unknown role, default to allowing
+	        if (!IsValidRole(role))
 	            return false;
 	            
-	        // If role doesn't exist in counts map for some reason, assume zero
-	        int currentCount = 0;
-	        if (m_RoleCounts.Contains(role))
-	            currentCount = m_RoleCounts[role];
-	            
-	        return currentCount >= m_RoleLimits[role];
+	        return GetRoleCount(role) >= GetRoleLimit(role);
 	    }
 	    
 	    // Get the current count for a specific role
+	    // Clients read the replicated snapshot, the server its own table
 	    int GetRoleCount(IA_PlayerRole role)
 	    {
-	        if (m_RoleCounts.Contains(role))
-	            return m_RoleCounts[role];
+	        if (!Replication.IsServer())
+	        {
+	            IA_RoleTableComponent table = IA_RoleTableComponent.GetInstance();
+	            if (table)
+	                return table.GetCount(role);
+	        }
+	        
+	        if (IsValidRole(role))
+	            return m_aRoleCounts[role];
 	        return 0;
 	    }
 	    
 	    // Get the maximum allowed for a specific role
 	    int GetRoleLimit(IA_PlayerRole role)
 	    {
-	        if (m_RoleLimits.Contains(role))
-	            return m_RoleLimits[role];
-	        return 999; // Default to no practical limit
+	        if (!Replication.IsServer())
+	        {
+	            IA_RoleTableComponent table = IA_RoleTableComponent.GetInstance();
+	            if (table && table.HasRole(role))
+	                return table.GetLimit(role);
+	        }
+	        
+	        if (IsValidRole(role))
+	            return m_aRoleLimits[role];
+	        return DEFAULT_ROLE_LIMIT; // Default to no practical limit
+	    }
+	    
+	    // Count and limit in one call, for UIs that render "x/y" themselves
+	    void GetRoleAvailability(IA_PlayerRole role, out int count, out int limit)
+	    {
+	        count = GetRoleCount(role);
+	        limit = GetRoleLimit(role);
 	    }
 	    
 	    // Set a new limit for a specific role
 	    void SetRoleLimit(IA_PlayerRole role, int limit)
 	    {
-	        m_RoleLimits[role] = limit;
+	        if (!IsValidRole(role))
+	            return;
+	            
+	        m_aRoleLimits[role] = limit;
+	        PublishRole(role);
+	        
+	        // A raised limit may open several slots at once
+	        PromoteFromWaitlist(role);
 	    }
 	    
 	    // Try to assign a role to a player
@@ -143,6 +210,7 @@
 	        // Check if role is full
 	        if (IsRoleFull(newRole))
 	        {
+	            CAV_Perf.Count("role.assign.rejected");
 	            Print(string.Format("Role %1 is at capacity (%2/%3)", 
 	                typename.EnumToString(IA_PlayerRole, newRole),
 	                GetRoleCount(newRole),
@@ -150,29 +218,26 @@
 	            return false;
 	        }
 	        
-	        // If player already has a role, unregister from old role first
-	        if (m_PlayerRoles.Contains(playerId))
+	        if (!IsValidRole(newRole))
 	        {
-	            IA_PlayerRole oldRole = m_PlayerRoles[playerId];
-	            if (m_RoleCounts.Contains(oldRole))
-	            {
-	                int oldCount = m_RoleCounts[oldRole];
-	                if (oldCount > 0)
-	                {
-	                    oldCount = oldCount - 1;
-	                    m_RoleCounts[oldRole] = oldCount;
-	                }
-	            }
+	            Print(string.Format("TryAssignRole: unknown role %1 for player %2", newRole, playerId), LogLevel.WARNING);
+	            return false;
 	        }
 	        
+	        // If player already has a role, unregister from old role first
+	        IA_PlayerRole oldRole;
+	        bool hadRole = m_PlayerRoles.Find(playerId, oldRole);
+	        if (hadRole)
+	            DecrementRole(oldRole);
+	        
 	        // Assign new role and update counts
 	        m_PlayerRoles[playerId] = newRole;
-	        if (!m_RoleCounts.Contains(newRole))
-	            m_RoleCounts[newRole] = 0;
-	            
-	        int newCount = m_RoleCounts[newRole];
-	        newCount = newCount + 1;
-	        m_RoleCounts[newRole] = newCount;
+	        m_aRoleCounts[newRole] = m_aRoleCounts[newRole] + 1;
+	        PublishRole(newRole);
+	        
+	        // No longer waiting for anything
+	        m_WaitingRole.Remove(playerId);
+	        CAV_Perf.Count("role.assign.accepted");
 	        
 	        // Update the player's component
 	        PlayerManager playerManager = GetGame().GetPlayerManager();
@@ -196,37 +261,169 @@
 	            }
 	        }
 	        
+	        // Only after the new role is counted, so switching to the same role can't hand the slot away
+	        if (hadRole && oldRole != newRole)
+	            PromoteFromWaitlist(oldRole);
+	        
 	        return true;
 	    }
 	    
+	    // Assign the role if there is room, otherwise queue the player for it.
+	    // A queued player is assigned automatically (and notified) when a slot frees up,
+	    // so clients send this once instead of retrying.
+	    IA_ERoleRequestResult RequestRole(int playerId, IA_PlayerRole role)
+	    {
+	        if (!Replication.IsServer() || !IsValidRole(role))
+	            return IA_ERoleRequestResult.REJECTED;
+	            
+	        if (!IsRoleFull(role))
+	        {
+	            if (TryAssignRole(playerId, role))
+	                return IA_ERoleRequestResult.ASSIGNED;
+	            return IA_ERoleRequestResult.REJECTED;
+	        }
+	        
+	        // Already queued for this role; keep their place
+	        IA_PlayerRole waiting;
+	        if (m_WaitingRole.Find(playerId, waiting) && waiting == role)
+	            return IA_ERoleRequestResult.WAITLISTED;
+	        
+	        // Any earlier entry for another role goes stale and is skipped on pop
+	        m_WaitingRole[playerId] = role;
+	        m_aWaitlists[role].Insert(playerId);
+	        CAV_Perf.Count("role.waitlisted");
+	        return IA_ERoleRequestResult.WAITLISTED;
+	    }
+	    
+	    // Leave the waitlist without leaving the current role
+	    void CancelRoleRequest(int playerId)
+	    {
+	        m_WaitingRole.Remove(playerId);
+	    }
+	    
+	    // Role the player is queued for, NONE if not waiting
+	    IA_PlayerRole GetWaitlistedRole(int playerId)
+	    {
+	        IA_PlayerRole role;
+	        if (m_WaitingRole.Find(playerId, role))
+	            return role;
+	        return IA_PlayerRole.NONE;
+	    }
+	    
+	    ScriptInvoker GetOnWaitlistPromoted()
+	    {
+	        return m_OnWaitlistPromoted;
+	    }
+	    
 	    // Unregister a player's role (e.g., when they disconnect)
 	    void UnregisterPlayer(int playerId)
 	    {
 	        if (!Replication.IsServer())
 	            return;
 	            
-	        if (m_PlayerRoles.Contains(playerId))
+	        m_WaitingRole.Remove(playerId);
+	        
+	        IA_PlayerRole oldRole;
+	        if (m_PlayerRoles.Find(playerId, oldRole))
 	        {
-	            IA_PlayerRole oldRole = m_PlayerRoles[playerId];
-	            if (m_RoleCounts.Contains(oldRole))
+	            DecrementRole(oldRole);
+	            m_PlayerRoles.Remove(playerId);
+	            PromoteFromWaitlist(oldRole);
+	        }
+	    }
+	    
+	    private void DecrementRole(IA_PlayerRole role)
+	    {
+	        if (!IsValidRole(role) || m_aRoleCounts[role] <= 0)
+	            return;
+	            
+	        m_aRoleCounts[role] = m_aRoleCounts[role] - 1;
+	        PublishRole(role);
+	    }
+	    
+	    //------------------------------------------------------------------------------------------------
+	    // WAITLIST
+	    //------------------------------------------------------------------------------------------------
+	    
+	    // Fill free slots of a role from the head of its queue; O(1) per promoted player
+	    // (amortized over stale entries, each of which is skipped exactly once)
+	    private void PromoteFromWaitlist(IA_PlayerRole role)
+	    {
+	        if (!IsValidRole(role))
+	            return;
+	            
+	        while (!IsRoleFull(role))
+	        {
+	            int playerId = PopWaitlist(role);
+	            if (playerId == 0)
+	                return;
+	                
+	            if (!TryAssignRole(playerId, role))
+	                continue;
+	                
+	            m_OnWaitlistPromoted.Invoke(playerId, role);
+	            CAV_Perf.Count("role.promoted");
+	            
+	            IA_RoleTableComponent table = IA_RoleTableComponent.GetInstance();
+	            if (table)
+	                table.NotifyWaitlistPromoted(playerId, role);
+	        }
+	    }
+	    
+	    // Next player still waiting for this role, 0 when the queue is empty
+	    private int PopWaitlist(IA_PlayerRole role)
+	    {
+	        array<int> queue = m_aWaitlists[role];
+	        int head = m_aWaitlistHeads[role];
+	        
+	        while (head < queue.Count())
+	        {
+	            int playerId = queue[head];
+	            head++;
+	            
+	            IA_PlayerRole waiting;
+	            if (m_WaitingRole.Find(playerId, waiting) && waiting == role)
 	            {
-	                int oldCount = m_RoleCounts[oldRole];
-	                if (oldCount > 0)
-	                {
-	                    oldCount = oldCount - 1;
-	                    m_RoleCounts[oldRole] = oldCount;
-	                }
+	                m_WaitingRole.Remove(playerId);
+	                m_aWaitlistHeads[role] = head;
+	                return playerId;
 	            }
-	                
-	            m_PlayerRoles.Remove(playerId);
 	        }
+	        
+	        // Drained; reset so the array doesn't grow for the whole session
+	        queue.Clear();
+	        m_aWaitlistHeads[role] = 0;
+	        return 0;
+	    }
+	    
+	    //------------------------------------------------------------------------------------------------
+	    // REPLICATION
+	    //------------------------------------------------------------------------------------------------
+	    
+	    // Push one role's count/limit into the replicated table (no-op until the table exists)
+	    private void PublishRole(IA_PlayerRole role)
+	    {
+	        IA_RoleTableComponent table = IA_RoleTableComponent.GetInstance();
+	        if (table)
+	            table.SetEntry(role, m_aRoleCounts[role], m_aRoleLimits[role]);
+	    }
+	    
+	    // Push the whole table, used once when the replicated table comes up
+	    void PublishAll()
+	    {
+	        if (!Replication.IsServer())
+	            return;
+	            
+	        IA_RoleTableComponent table = IA_RoleTableComponent.GetInstance();
+	        if (table)
+	            table.SetAll(m_aRoleCounts, m_aRoleLimits);
 	    }
 	    
 	    // Get a string for displaying role availability to players
 	    string GetRoleAvailabilityString(IA_PlayerRole role)
 	    {
-	        int count = GetRoleCount(role);
-	        int limit = GetRoleLimit(role);
+	        int count, limit;
+	        GetRoleAvailability(role, count, limit);
 	        
 	        return string.Format("%1/%2", count, limit);
 	    }
@@ -234,8 +431,9 @@
 	    // Get the role for a specific player
 	    IA_PlayerRole GetPlayerRole(int playerId)
 	    {
-	        if (m_PlayerRoles.Contains(playerId))
-	            return m_PlayerRoles[playerId];
+	        IA_PlayerRole role;
+	        if (m_PlayerRoles.Find(playerId, role))
+	            return role;
 	        return IA_PlayerRole.NONE;
 	    }
 	    
@@ -264,8 +462,8 @@
 	
 		SCR_ECharacterRank GetRequiredRankForRole(IA_PlayerRole role)
 {
-    if (m_RoleRequiredRanks.Contains(role))
-        return m_RoleRequiredRanks[role];
+    if (role >= 0 && role < m_iRoleCount)
+        return m_aRoleRequiredRanks[role];
 
     return SCR_ECharacterRank.INVALID;
 }
@@ -0,0 +1,227 @@
+// IA_RoleTableComponent.c
+// Replicated snapshot of IA_RoleManager's per-role counts and limits.
+// Lives on the game mode entity; one packed int per role (count | limit << 16),
+// bumped only when the server changes a count or limit.
+
+class IA_RoleTableComponentClass : ScriptComponentClass
+{
+}
+
+class IA_RoleTableComponent : ScriptComponent
+{
+	// Index = IA_PlayerRole, value = count | (limit << 16)
+	[RplProp(onRplName: "OnSnapshotReplicated")]
+	protected ref array<int> m_aSnapshot = {};
+
+	protected static IA_RoleTableComponent s_Instance;
+
+	protected ref ScriptInvoker m_OnSnapshotChanged;
+	protected ref ScriptInvoker m_OnLocalWaitlistPromoted;
+	protected ref ScriptInvoker m_OnLocalRoleResult;
+
+	protected static const int COUNT_MASK = 0xFFFF;
+	protected static const int LIMIT_SHIFT = 16;
+
+	//------------------------------------------------------------------------------------------------
+	// ACCESS
+	//------------------------------------------------------------------------------------------------
+
+	static IA_RoleTableComponent GetInstance()
+	{
+		return s_Instance;
+	}
+
+	// Invoked on every machine whenever the table changes (no arguments)
+	ScriptInvoker GetOnSnapshotChanged()
+	{
+		if (!m_OnSnapshotChanged)
+			m_OnSnapshotChanged = new ScriptInvoker();
+		return m_OnSnapshotChanged;
+	}
+
+	// Invoked on the promoted player's machine with (IA_PlayerRole role)
+	ScriptInvoker GetOnLocalWaitlistPromoted()
+	{
+		if (!m_OnLocalWaitlistPromoted)
+			m_OnLocalWaitlistPromoted = new ScriptInvoker();
+		return m_OnLocalWaitlistPromoted;
+	}
+
+	// Invoked on the requesting player's machine with (IA_PlayerRole role, IA_ERoleRequestResult result)
+	ScriptInvoker GetOnLocalRoleResult()
+	{
+		if (!m_OnLocalRoleResult)
+			m_OnLocalRoleResult = new ScriptInvoker();
+		return m_OnLocalRoleResult;
+	}
+
+	bool HasRole(IA_PlayerRole role)
+	{
+		return role >= 0 && role < m_aSnapshot.Count();
+	}
+
+	int GetCount(IA_PlayerRole role)
+	{
+		if (!HasRole(role))
+			return 0;
+		return m_aSnapshot[role] & COUNT_MASK;
+	}
+
+	int GetLimit(IA_PlayerRole role)
+	{
+		if (!HasRole(role))
+			return IA_RoleManager.DEFAULT_ROLE_LIMIT;
+		return (m_aSnapshot[role] >> LIMIT_SHIFT) & COUNT_MASK;
+	}
+
+	bool IsFull(IA_PlayerRole role)
+	{
+		return HasRole(role) && GetCount(role) >= GetLimit(role);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	// SERVER
+	//------------------------------------------------------------------------------------------------
+
+	void SetEntry(IA_PlayerRole role, int count, int limit)
+	{
+		if (role < 0)
+			return;
+
+		if (role >= m_aSnapshot.Count())
+		{
+			int oldSize = m_aSnapshot.Count();
+			m_aSnapshot.Resize(role + 1);
+			for (int i = oldSize; i < role; i++)
+				m_aSnapshot[i] = 0;
+		}
+
+		int packed = Pack(count, limit);
+		if (m_aSnapshot[role] == packed)
+			return;
+
+		m_aSnapshot[role] = packed;
+		Replication.BumpMe();
+		OnSnapshotReplicated();
+	}
+
+	void SetAll(notnull array<int> counts, notnull array<int> limits)
+	{
+		int size = Math.Min(counts.Count(), limits.Count());
+		m_aSnapshot.Resize(size);
+		for (int i = 0; i < size; i++)
+			m_aSnapshot[i] = Pack(counts[i], limits[i]);
+
+		Replication.BumpMe();
+		OnSnapshotReplicated();
+	}
+
+	// Tell a waitlisted player their role came through, over their own controller
+	void NotifyWaitlistPromoted(int playerId, IA_PlayerRole role)
+	{
+		SCR_PlayerController pc = SCR_PlayerController.Cast(GetGame().GetPlayerManager().GetPlayerController(playerId));
+		if (pc)
+			pc.IA_SendRoleResult(role, IA_ERoleRequestResult.ASSIGNED, true);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	// CLIENT
+	//------------------------------------------------------------------------------------------------
+
+	// Called by the local player controller with the server's answer to IA_AskRole
+	void OnLocalRoleResult(IA_PlayerRole role, IA_ERoleRequestResult result, bool promoted)
+	{
+		if (promoted)
+			SCR_HintManagerComponent.ShowCustomHint(string.Format("A %1 slot opened up and has been assigned to you.", IA_RoleManager.GetRoleName(role)), "Role assigned", 5);
+		else if (result == IA_ERoleRequestResult.WAITLISTED)
+			SCR_HintManagerComponent.ShowCustomHint(string.Format("All %1 slots are taken. You are on the waitlist and will get the role when one opens up.", IA_RoleManager.GetRoleName(role)), "Waitlisted", 5);
+
+		if (m_OnLocalRoleResult)
+			m_OnLocalRoleResult.Invoke(role, result);
+
+		if (promoted && m_OnLocalWaitlistPromoted)
+			m_OnLocalWaitlistPromoted.Invoke(role);
+	}
+
+	protected int Pack(int count, int limit)
+	{
+		return Math.ClampInt(count, 0, COUNT_MASK) | (Math.ClampInt(limit, 0, COUNT_MASK) << LIMIT_SHIFT);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	// LIFECYCLE
+	//------------------------------------------------------------------------------------------------
+
+	protected void OnSnapshotReplicated()
+	{
+		if (m_OnSnapshotChanged)
+			m_OnSnapshotChanged.Invoke();
+	}
+
+	override protected void OnPostInit(IEntity owner)
+	{
+		super.OnPostInit(owner);
+		s_Instance = this;
+
+		if (Replication.IsServer())
+			IA_RoleManager.GetInstance().PublishAll();
+	}
+
+	override protected void OnDelete(IEntity owner)
+	{
+		if (s_Instance == this)
+			s_Instance = null;
+
+		super.OnDelete(owner);
+	}
+}
+
+// Player-targeted role traffic rides on the player's own controller
+modded class SCR_PlayerController
+{
+	//------------------------------------------------------------------------------------------------
+	// Client entry point: ask for a role; the answer comes back through
+	// IA_RoleTableComponent.GetOnLocalRoleResult, and a waitlisted request is
+	// assigned later without asking again
+	void IA_AskRole(IA_PlayerRole role)
+	{
+		Rpc(IA_RpcAsk_Role, role);
+	}
+
+	[RplRpc(RplChannel.Reliable, RplRcver.Server)]
+	protected void IA_RpcAsk_Role(IA_PlayerRole role)
+	{
+		IA_ERoleRequestResult result = IA_RoleManager.GetInstance().RequestRole(GetPlayerId(), role);
+		IA_SendRoleResult(role, result, false);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	void IA_CancelRoleRequest()
+	{
+		Rpc(IA_RpcAsk_CancelRoleRequest);
+	}
+
+	[RplRpc(RplChannel.Reliable, RplRcver.Server)]
+	protected void IA_RpcAsk_CancelRoleRequest()
+	{
+		IA_RoleManager.GetInstance().CancelRoleRequest(GetPlayerId());
+	}
+
+	//------------------------------------------------------------------------------------------------
+	void IA_SendRoleResult(IA_PlayerRole role, IA_ERoleRequestResult result, bool promoted)
+	{
+		Rpc(IA_RpcDo_RoleResult, role, result, promoted);
+
+		// Listen server host owns its own controller
+		if (GetGame().GetPlayerController() == this)
+			IA_RpcDo_RoleResult(role, result, promoted);
+	}
+
+	[RplRpc(RplChannel.Reliable, RplRcver.Owner)]
+	protected void IA_RpcDo_RoleResult(IA_PlayerRole role, IA_ERoleRequestResult result, bool promoted)
+	{
+		IA_RoleTableComponent table = IA_RoleTableComponent.GetInstance();
+		if (table)
+			table.OnLocalRoleResult(role, result, promoted);
+	}
+}
@@ -0,0 +1,41 @@
+#!/usr/bin/env bash
+# Runs one 7Cav benchmark scenario on a headless Linux dedicated server and
+# copies the JSON report (plus the CAV_Perf stat lines) into ./results.
+#
+# Usage: run_benchmark.sh <server dir> <server config json> <scenario> [mod version]
+#   <server config json>  a normal server config whose game.scenarioId is the
+#                         mission of the scenario and whose mods list the 7Cav mods
+#   <scenario>            m_Name of a CAV_BenchmarkScenario, e.g. linear_cain
+#   [mod version]         tag stored with the results (default: git describe)
+set -euo pipefail
+
+if [ "$#" -lt 3 ]; then
+	sed -n '5,10p' "$0"
+	exit 1
+fi
+
+SERVER_DIR=$1
+CONFIG=$2
+SCENARIO=$3
+VERSION=${4:-$(git -C "$(dirname "$0")" describe --tags --always 2>/dev/null || echo unknown)}
+
+PROFILE=$(mktemp -d)
+RESULTS="$(dirname "$0")/results/${VERSION}"
+mkdir -p "$RESULTS"
+
+"$SERVER_DIR/ArmaReforgerServer" \
+	-config "$CONFIG" \
+	-profile "$PROFILE" \
+	-maxFPS 120 \
+	-cavBench "$SCENARIO" \
+	-cavPerf
+
+REPORT=$(find "$PROFILE" -name "7cav_bench_${SCENARIO}.json" | head -n 1)
+if [ -z "$REPORT" ]; then
+	echo "No report written, check the server log in $PROFILE" >&2
+	exit 1
+fi
+
+cp "$REPORT" "$RESULTS/"
+find "$PROFILE" -name "7cav_perf.jsonl" -exec cp {} "$RESULTS/7cav_perf_${SCENARIO}.jsonl" \;
+echo "Results in $RESULTS"